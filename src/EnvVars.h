@@ -25,6 +25,27 @@
  */
 #define SORT_DEADHEAD_ARCS "SORT_DEADHEAD_ARCS"
 
+/**
+ * Flags whether provably dominated deadhead arcs should be removed when loading
+ * the instance.
+ * Default value: 1 (true)
+ */
+#define PREPROCESS_DEADHEAD_ARCS "PREPROCESS_DEADHEAD_ARCS"
+
+/**
+ * Flags whether forced trip sequences should be contracted into single nodes
+ * of the pricing graph. Only affects spfa and bellman pricing.
+ * Default value: 0 (false)
+ */
+#define CONTRACT_TRIP_CHAINS "CONTRACT_TRIP_CHAINS"
+
+/**
+ * Number of randomized constructions of the greedy heuristic used to seed the
+ * master problem before the first column generation iteration.
+ * Default value: 16 (0 disables the heuristic)
+ */
+#define GREEDY_STARTS "GREEDY_STARTS"
+
 /**
  * Limits the number of column generation iterations in each step of the
  * truncated column generation algorithm.
@@ -54,6 +75,113 @@
  */
 #define TCG_GRASP_ALPHA "TCG_GRASP_ALPHA" 
 
+/**
+ * Number of independent GRASP dives of the truncated column generation. With
+ * more than one dive, dives run in parallel over copies of the master problem,
+ * each one with its own random seed. Not supported with the GLPK master or pricing.
+ * Default value: 1
+ */
+#define TCG_DIVES "TCG_DIVES"
+
+/**
+ * Batch fixing in the truncated column generation: besides the selected column,
+ * every compatible candidate whose value in the RMP is at least the threshold is
+ * fixed in the same round.
+ * Values: [0.0, 1.0], default of 0.0 (disabled)
+ */
+#define TCG_FIX_THRESHOLD "TCG_FIX_THRESHOLD"
+
+/**
+ * Batch fixing in the truncated column generation: fixes up to k compatible
+ * candidates per round, by decreasing value in the RMP.
+ * Default value: 1 (single column per round)
+ */
+#define TCG_FIX_TOP_K "TCG_FIX_TOP_K"
+
+/**
+ * Maximum number of backtracks of each dive of the truncated column generation.
+ * A dive backtracks when a round degrades the RMP objective past the threshold, 
+ * or leaves the RMP relying on dummy columns. Backtracking turns off the reduced-cost
+ * arc fixing inside the dives, since the removed arcs are not restored.
+ * Default value: 0 (disabled)
+ */
+#define TCG_BACKTRACKS "TCG_BACKTRACKS"
+
+/**
+ * Number of recent rounds that a backtrack can revert, which is also the number
+ * of alternative candidates kept for each round.
+ * Default value: 3
+ */
+#define TCG_BACKTRACK_DEPTH "TCG_BACKTRACK_DEPTH"
+
+/**
+ * Relative increase of the RMP objective, in a single round, that triggers a backtrack.
+ * Default value: 0.01
+ */
+#define TCG_BACKTRACK_THRESHOLD "TCG_BACKTRACK_THRESHOLD"
+
+/**
+ * Number of column generation iterations between two rounds of reduced-cost
+ * arc fixing. Fixing only happens when an upper bound is known.
+ * Default value: 10 (0 disables the fixing)
+ */
+#define RC_FIXING_INTERVAL "RC_FIXING_INTERVAL"
+
+/**
+ * Seconds between two checkpoints of the branch-and-price search.
+ * Default value: 60
+ */
+#define BP_CHECKPOINT_INTERVAL "BP_CHECKPOINT_INTERVAL"
+
+/**
+ * Flags whether the LP files exported after the column generation should be
+ * compressed with gzip. Compressed files get the '.gz' suffix.
+ * Default value: 1 (true)
+ */
+#define EXPORT_COMPRESS "EXPORT_COMPRESS"
+
+/**
+ * Seconds between two rounds of the pool MIP heuristic (option --pool-mip).
+ * Default value: 30
+ */
+#define POOL_MIP_INTERVAL "POOL_MIP_INTERVAL"
+
+/**
+ * Time limit, in seconds, of each round of the pool MIP heuristic.
+ * Default value: 10
+ */
+#define POOL_MIP_TIME_LIMIT "POOL_MIP_TIME_LIMIT"
+
+/**
+ * Maximum number of rounds of the local search applied to the final schedule.
+ * Set to 0 to disable the local search.
+ * Default value: 1000
+ */
+#define LOCAL_SEARCH_ROUNDS "LOCAL_SEARCH_ROUNDS"
+
+/**
+ * Maximum number of columns created per iteration of the column generation by
+ * recombining the columns of the RMP solution. The pricing only runs when the
+ * recombination finds no column. Set to 0 to disable the recombination.
+ * Default value: 0
+ */
+#define RECOMBINATION_COLUMNS "RECOMBINATION_COLUMNS"
+
+/**
+ * Relative complementarity gap at which the barrier stops when solving the RMP
+ * for central duals (--central-duals). Only used by the cplex master, CLP stops
+ * the barrier at its own tolerance.
+ * Default value: 1e-4
+ */
+#define BARRIER_GAP "BARRIER_GAP"
+
+/**
+ * Maximum number of subgradient iterations of the Lagrangian relaxation, used by
+ * --method lagrangian and --lagrangian-warm-start.
+ * Default value: 3000
+ */
+#define LAGRANGIAN_ITERATIONS "LAGRANGIAN_ITERATIONS"
+
 inline auto getEnvMaxLabelExpansions() noexcept -> int {
    if (getenv(MAX_LABEL_EXPANSIONS)) {
       int value = std::stoi(getenv(MAX_LABEL_EXPANSIONS));
@@ -91,6 +219,38 @@ inline auto getEnvSortDeadheadArcs() noexcept -> bool {
    return false;
 }
 
+inline auto getEnvPreprocessDeadheadArcs() noexcept -> bool {
+   if (getenv(PREPROCESS_DEADHEAD_ARCS)) {
+      bool value = std::stoi(getenv(PREPROCESS_DEADHEAD_ARCS)) == 0 ? false : true;
+      std::cout << "Read PREPROCESS_DEADHEAD_ARCS = " << value << "\n";
+      return value;
+   }
+   return true;
+}
+
+inline auto getEnvContractTripChains() noexcept -> bool {
+   if (getenv(CONTRACT_TRIP_CHAINS)) {
+      bool value = std::stoi(getenv(CONTRACT_TRIP_CHAINS)) == 0 ? false : true;
+      std::cout << "Read CONTRACT_TRIP_CHAINS = " << value << "\n";
+      return value;
+   }
+   return false;
+}
+
+inline auto getEnvGreedyStarts() noexcept -> int {
+   if (getenv(GREEDY_STARTS)) {
+      int value = std::stoi(getenv(GREEDY_STARTS));
+      if (value >= 0) {
+         std::cout << "Read GREEDY_STARTS = " << value << "\n";
+      } else {
+         std::cout << "Bad value for GREEDY_STARTS: " << getenv(GREEDY_STARTS) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 16;
+}
+
 inline auto getEnvMaxTcgSubIter() noexcept -> int {
    if (getenv(TCG_MAX_SUB_ITERATIONS)) {
       int value = std::stoi(getenv(TCG_MAX_SUB_ITERATIONS));
@@ -144,4 +304,209 @@ inline auto getEnvTcgGraspAlpha() noexcept -> double {
    const auto value = std::stod(rawValue);
    std::cout << "Read TCG_GRASP_ALPHA = " << value << "\n";
    return value;
+}
+
+inline auto getEnvTcgDives() noexcept -> int {
+   if (getenv(TCG_DIVES)) {
+      int value = std::stoi(getenv(TCG_DIVES));
+      if (value > 0) {
+         std::cout << "Read TCG_DIVES = " << value << "\n";
+      } else {
+         std::cout << "Bad value for TCG_DIVES: " << getenv(TCG_DIVES) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 1;
+}
+
+inline auto getEnvTcgFixThreshold() noexcept -> double {
+   if (getenv(TCG_FIX_THRESHOLD)) {
+      double value = std::stod(getenv(TCG_FIX_THRESHOLD));
+      if (value >= 0.0 && value <= 1.0) {
+         std::cout << "Read TCG_FIX_THRESHOLD = " << value << "\n";
+      } else {
+         std::cout << "Bad value for TCG_FIX_THRESHOLD: " << getenv(TCG_FIX_THRESHOLD) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 0.0;
+}
+
+inline auto getEnvTcgFixTopK() noexcept -> int {
+   if (getenv(TCG_FIX_TOP_K)) {
+      int value = std::stoi(getenv(TCG_FIX_TOP_K));
+      if (value > 0) {
+         std::cout << "Read TCG_FIX_TOP_K = " << value << "\n";
+      } else {
+         std::cout << "Bad value for TCG_FIX_TOP_K: " << getenv(TCG_FIX_TOP_K) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 1;
+}
+
+inline auto getEnvTcgBacktracks() noexcept -> int {
+   if (getenv(TCG_BACKTRACKS)) {
+      int value = std::stoi(getenv(TCG_BACKTRACKS));
+      if (value >= 0) {
+         std::cout << "Read TCG_BACKTRACKS = " << value << "\n";
+      } else {
+         std::cout << "Bad value for TCG_BACKTRACKS: " << getenv(TCG_BACKTRACKS) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 0;
+}
+
+inline auto getEnvTcgBacktrackDepth() noexcept -> int {
+   if (getenv(TCG_BACKTRACK_DEPTH)) {
+      int value = std::stoi(getenv(TCG_BACKTRACK_DEPTH));
+      if (value > 0) {
+         std::cout << "Read TCG_BACKTRACK_DEPTH = " << value << "\n";
+      } else {
+         std::cout << "Bad value for TCG_BACKTRACK_DEPTH: " << getenv(TCG_BACKTRACK_DEPTH) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 3;
+}
+
+inline auto getEnvTcgBacktrackThreshold() noexcept -> double {
+   if (getenv(TCG_BACKTRACK_THRESHOLD)) {
+      double value = std::stod(getenv(TCG_BACKTRACK_THRESHOLD));
+      if (value >= 0.0) {
+         std::cout << "Read TCG_BACKTRACK_THRESHOLD = " << value << "\n";
+      } else {
+         std::cout << "Bad value for TCG_BACKTRACK_THRESHOLD: " << getenv(TCG_BACKTRACK_THRESHOLD) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 0.01;
+}
+
+inline auto getEnvRcFixingInterval() noexcept -> int {
+   if (getenv(RC_FIXING_INTERVAL)) {
+      int value = std::stoi(getenv(RC_FIXING_INTERVAL));
+      if (value >= 0) {
+         std::cout << "Read RC_FIXING_INTERVAL = " << value << "\n";
+      } else {
+         std::cout << "Bad value for RC_FIXING_INTERVAL: " << getenv(RC_FIXING_INTERVAL) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 10;
+}
+
+inline auto getEnvBpCheckpointInterval() noexcept -> double {
+   if (getenv(BP_CHECKPOINT_INTERVAL)) {
+      double value = std::stod(getenv(BP_CHECKPOINT_INTERVAL));
+      if (value > 0.0) {
+         std::cout << "Read BP_CHECKPOINT_INTERVAL = " << value << "\n";
+      } else {
+         std::cout << "Bad value for BP_CHECKPOINT_INTERVAL: " << getenv(BP_CHECKPOINT_INTERVAL) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 60.0;
+}
+
+inline auto getEnvExportCompress() noexcept -> bool {
+   if (getenv(EXPORT_COMPRESS)) {
+      bool value = std::stoi(getenv(EXPORT_COMPRESS)) == 0 ? false : true;
+      std::cout << "Read EXPORT_COMPRESS = " << value << "\n";
+      return value;
+   }
+   return true;
+}
+
+inline auto getEnvPoolMipInterval() noexcept -> double {
+   if (getenv(POOL_MIP_INTERVAL)) {
+      double value = std::stod(getenv(POOL_MIP_INTERVAL));
+      if (value > 0.0) {
+         std::cout << "Read POOL_MIP_INTERVAL = " << value << "\n";
+      } else {
+         std::cout << "Bad value for POOL_MIP_INTERVAL: " << getenv(POOL_MIP_INTERVAL) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 30.0;
+}
+
+inline auto getEnvPoolMipTimeLimit() noexcept -> double {
+   if (getenv(POOL_MIP_TIME_LIMIT)) {
+      double value = std::stod(getenv(POOL_MIP_TIME_LIMIT));
+      if (value > 0.0) {
+         std::cout << "Read POOL_MIP_TIME_LIMIT = " << value << "\n";
+      } else {
+         std::cout << "Bad value for POOL_MIP_TIME_LIMIT: " << getenv(POOL_MIP_TIME_LIMIT) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 10.0;
+}
+
+inline auto getEnvLocalSearchRounds() noexcept -> int {
+   if (getenv(LOCAL_SEARCH_ROUNDS)) {
+      int value = std::stoi(getenv(LOCAL_SEARCH_ROUNDS));
+      if (value >= 0) {
+         std::cout << "Read LOCAL_SEARCH_ROUNDS = " << value << "\n";
+      } else {
+         std::cout << "Bad value for LOCAL_SEARCH_ROUNDS: " << getenv(LOCAL_SEARCH_ROUNDS) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 1000;
+}
+
+inline auto getEnvRecombinationColumns() noexcept -> int {
+   if (getenv(RECOMBINATION_COLUMNS)) {
+      int value = std::stoi(getenv(RECOMBINATION_COLUMNS));
+      if (value >= 0) {
+         std::cout << "Read RECOMBINATION_COLUMNS = " << value << "\n";
+      } else {
+         std::cout << "Bad value for RECOMBINATION_COLUMNS: " << getenv(RECOMBINATION_COLUMNS) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 0;
+}
+
+inline auto getEnvBarrierGap() noexcept -> double {
+   if (getenv(BARRIER_GAP)) {
+      double value = std::stod(getenv(BARRIER_GAP));
+      if (value > 0.0) {
+         std::cout << "Read BARRIER_GAP = " << value << "\n";
+      } else {
+         std::cout << "Bad value for BARRIER_GAP: " << getenv(BARRIER_GAP) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 1e-4;
+}
+
+inline auto getEnvLagrangianIterations() noexcept -> int {
+   if (getenv(LAGRANGIAN_ITERATIONS)) {
+      int value = std::stoi(getenv(LAGRANGIAN_ITERATIONS));
+      if (value > 0) {
+         std::cout << "Read LAGRANGIAN_ITERATIONS = " << value << "\n";
+      } else {
+         std::cout << "Bad value for LAGRANGIAN_ITERATIONS: " << getenv(LAGRANGIAN_ITERATIONS) << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      return value;
+   }
+   return 3000;
 }
\ No newline at end of file
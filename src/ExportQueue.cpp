@@ -0,0 +1,121 @@
+#include "ExportQueue.h"
+#include "Timer.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+using namespace std;
+
+ExportQueue::ExportQueue(bool compress): m_compress(compress), m_worker(&ExportQueue::run, this) {
+}
+
+ExportQueue::~ExportQueue() {
+   {
+      lock_guard<mutex> lock(m_mutex);
+      m_stop = true;
+   }
+   m_cv.notify_all();
+   m_worker.join();
+}
+
+auto ExportQueue::push(const string &fname, Writer write, bool compressible) noexcept -> string {
+   const bool compress = m_compress && compressible;
+   {
+      lock_guard<mutex> lock(m_mutex);
+      m_jobs.push_back({fname, move(write), compress});
+   }
+   m_cv.notify_all();
+   return compress ? fname + ".gz" : fname;
+}
+
+auto ExportQueue::wait() noexcept -> void {
+   unique_lock<mutex> lock(m_mutex);
+   m_cv.wait(lock, [this]() { return m_jobs.empty() && !m_busy; });
+}
+
+auto ExportQueue::run() noexcept -> void {
+   unique_lock<mutex> lock(m_mutex);
+   while (true) {
+      m_cv.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+      // Pending files are still written when stopping.
+      if (m_jobs.empty())
+         return;
+
+      auto job = move(m_jobs.front());
+      m_jobs.pop_front();
+      m_busy = true;
+      lock.unlock();
+
+      Timer tm;
+      tm.start();
+      ostringstream msg;
+      if (job.compress) {
+         const auto gzName = job.fname + ".gz";
+         if (writeCompressed(job.fname.c_str(), job.write, gzName.c_str())) {
+            msg << "Background export: '" << gzName << "' written in " << tm.elapsed() << " sec.\n";
+         } else {
+            job.write(job.fname.c_str());
+            msg << "WARNING: Could not compress '" << job.fname << "', kept uncompressed.\n";
+         }
+      } else {
+         job.write(job.fname.c_str());
+         msg << "Background export: '" << job.fname << "' written in " << tm.elapsed() << " sec.\n";
+      }
+      cout << msg.str() << flush;
+
+      lock.lock();
+      m_busy = false;
+      m_cv.notify_all();
+   }
+}
+
+auto ExportQueue::writeCompressed(const char *fname, const Writer &write, const char *gzName) noexcept -> bool {
+   // The writer fills a named pipe, which a second thread reads and compresses.
+   remove(fname);
+   if (mkfifo(fname, 0644) != 0)
+      return false;
+   bool ok = false;
+   thread reader([&]() {
+      ok = gzipFile(fname, gzName);
+   });
+
+   // Holds the pipe open while the writer runs, so the reader only finds the end of
+   // the file once the writer is done, even if the writer never opens it.
+   const int fd = open(fname, O_WRONLY);
+   write(fname);
+   if (fd != -1)
+      close(fd);
+   reader.join();
+   remove(fname);
+   return ok;
+}
+
+auto gzipFile(const char *src, const char *dst) noexcept -> bool {
+   ifstream in(src, ios::binary);
+   if (!in)
+      return false;
+   gzFile out = gzopen(dst, "wb6");
+
+   // The input is read to its end even after a failure, so a writer on the other
+   // end of a pipe is never left blocked.
+   vector<char> buf(1 << 20);
+   bool ok = out != nullptr;
+   while (in) {
+      in.read(buf.data(), buf.size());
+      if (ok && in.gcount() > 0)
+         ok = gzwrite(out, buf.data(), in.gcount()) == in.gcount();
+   }
+   if (out)
+      ok = gzclose(out) == Z_OK && ok;
+   if (!ok)
+      remove(dst);
+   return ok;
+}
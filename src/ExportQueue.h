@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Writes files on a background thread.
+ *
+ * Files are written one at a time, in the order they were queued, so writers
+ * queued one after the other may share and modify the same snapshot of a model.
+ * The snapshot must be taken by the caller, since the writers run while the
+ * main flow goes on. When compression is enabled, compressible files are
+ * gzipped into `fname.gz` as they are written, through a named pipe at `fname`,
+ * so the plain text never reaches the disk.
+ */
+class ExportQueue {
+public:
+   // Writes the file into the path it receives.
+   using Writer = std::function<void(const char *fname)>;
+
+   ExportQueue(bool compress);
+
+   // Waits for all queued files to be written.
+   virtual ~ExportQueue();
+
+   // Queues the file `fname`. Files that must be read back by the solver, such as
+   // the column files, should not be compressed. Returns the name of the file that
+   // will be written.
+   auto push(const std::string &fname, Writer write, bool compressible = true) noexcept -> std::string;
+
+   // Blocks until all queued files are written.
+   auto wait() noexcept -> void;
+
+private:
+   struct Job {
+      std::string fname;
+      Writer write;
+      bool compress;
+   };
+
+   bool m_compress;
+   std::deque<Job> m_jobs;
+   std::mutex m_mutex;
+   std::condition_variable m_cv;
+   bool m_busy{false};
+   bool m_stop{false};
+   std::thread m_worker;
+
+   auto run() noexcept -> void;
+
+   // Runs `write` on a named pipe at `fname`, and compresses what it writes into
+   // `gzName`. Returns false if the pipe can not be created or the compression fails.
+   static auto writeCompressed(const char *fname, const Writer &write, const char *gzName) noexcept -> bool;
+};
+
+// Compresses `src` into `dst` with gzip. Returns false on failure.
+auto gzipFile(const char *src, const char *dst) noexcept -> bool;
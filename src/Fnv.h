@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 64-bit FNV-1a hash of `len` bytes. Passing the result of a previous call as
+ * `hash` continues the hash over multiple buffers.
+ */
+inline auto fnv1a(const void *data, size_t len, uint64_t hash = 14695981039346656037ull) noexcept -> uint64_t {
+   auto bytes = static_cast<const unsigned char *>(data);
+   for (size_t i = 0; i < len; ++i) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+   }
+   return hash;
+}
@@ -1,4 +1,5 @@
 #include "Instance.h"
+#include "Fnv.h"
 
 #include <algorithm>
 #include <cassert>
@@ -7,7 +8,7 @@
 
 using namespace std;
 
-Instance::Instance(const char *fname, bool sortDeadheadArcs): m_fname{fname} {
+Instance::Instance(const char *fname, bool sortDeadheadArcs, bool preprocessArcs): m_fname{fname} {
    // RAII style: tries to read the instance data in the constructor.
    ifstream fid(fname);
    if (!fid) {
@@ -31,6 +32,10 @@ Instance::Instance(const char *fname, bool sortDeadheadArcs): m_fname{fname} {
          fid >> m_matrix[i][j];
       }
    }
+   m_fingerprint = fnv1a(&m_numDepots, sizeof m_numDepots);
+   m_fingerprint = fnv1a(&m_numTrips, sizeof m_numTrips, m_fingerprint);
+   m_fingerprint = fnv1a(m_depotCap.data(), m_depotCap.size() * sizeof(int), m_fingerprint);
+   m_fingerprint = fnv1a(m_matrix.data(), m_matrix.num_elements() * sizeof(int), m_fingerprint);
 
    auto cacheEntryComparator = [](const std::pair<int,int> &a, const std::pair<int,int> &b) {
       return get<1>(a) < get<1>(b);
@@ -58,6 +63,32 @@ Instance::Instance(const char *fname, bool sortDeadheadArcs): m_fname{fname} {
          sort(vecPred.begin(), vecPred.end(), cacheEntryComparator);
       }
    }
+
+   // Computes a topological order of the trips (Kahn's algorithm). The deadheading
+   // network of a MDVSP is acyclic, so this order always covers all trips.
+   vector<int> inDegree(numTrips(), 0);
+   for (int i = 0; i < numTrips(); ++i)
+      inDegree[i] = m_dhCachePred[i].size();
+   m_topoOrder.reserve(numTrips());
+   for (int i = 0; i < numTrips(); ++i) {
+      if (inDegree[i] == 0)
+         m_topoOrder.push_back(i);
+   }
+   for (size_t pos = 0; pos < m_topoOrder.size(); ++pos) {
+      for (auto &p: m_dhCacheSucc[m_topoOrder[pos]]) {
+         if (--inDegree[p.first] == 0)
+            m_topoOrder.push_back(p.first);
+      }
+   }
+   if ((int) m_topoOrder.size() != numTrips()) {
+      cerr << "Instance " << fname << " has cycles in the deadheading network.\n";
+      exit(EXIT_FAILURE);
+   }
+
+   m_dhDepotSucc.resize(numDepots());
+   m_dhDepotPred.resize(numDepots());
+   if (preprocessArcs)
+      preprocessDeadheadArcs();
 }
 
 Instance::~Instance() {
@@ -76,6 +107,10 @@ auto Instance::numTrips() const noexcept -> int {
    return m_numTrips;
 }
 
+auto Instance::fingerprint() const noexcept -> uint64_t {
+   return m_fingerprint;
+}
+
 auto Instance::depotCapacity(int k) const noexcept -> int {
    assert(k >= 0 && k < m_numDepots);
    return m_depotCap[k];
@@ -107,4 +142,140 @@ auto Instance::deadheadSuccAdj(int pred) const noexcept -> const std::vector<std
 auto Instance::deadheadPredAdj(int succ) const noexcept -> const std::vector<std::pair<int, int>> & {
    assert(succ >= 0 && succ < m_numTrips);
    return m_dhCachePred[succ];
-}
\ No newline at end of file
+}
+
+auto Instance::topologicalOrder() const noexcept -> const std::vector<int> & {
+   return m_topoOrder;
+}
+
+auto Instance::deadheadSuccAdj(int k, int pred) const noexcept -> const std::vector<std::pair<int, int>> & {
+   assert(k >= 0 && k < m_numDepots);
+   assert(pred >= 0 && pred < m_numTrips);
+   if (m_dhDepotSucc[k].empty())
+      return m_dhCacheSucc[pred];
+   return m_dhDepotSucc[k][pred];
+}
+
+auto Instance::deadheadPredAdj(int k, int succ) const noexcept -> const std::vector<std::pair<int, int>> & {
+   assert(k >= 0 && k < m_numDepots);
+   assert(succ >= 0 && succ < m_numTrips);
+   if (m_dhDepotPred[k].empty())
+      return m_dhCachePred[succ];
+   return m_dhDepotPred[k][succ];
+}
+
+auto Instance::hasDeadheadArc(int k, int pred, int succ) const noexcept -> bool {
+   if (deadheadCost(pred, succ) == -1)
+      return false;
+   if (m_dhDepotSucc[k].empty())
+      return true;
+   const auto &adj = m_dhDepotSucc[k][pred];
+   return find_if(adj.begin(), adj.end(), [&](const pair<int, int> &p) { return p.first == succ; }) != adj.end();
+}
+
+auto Instance::numDominatedArcs() const noexcept -> long {
+   return m_numDominatedArcs;
+}
+
+auto Instance::preprocessDeadheadArcs() noexcept -> void {
+   const auto K = numDepots();
+   const auto N = numTrips();
+
+   // Number of depots that can use each arc, indexed as the successor cache.
+   vector<vector<int>> usage(N);
+   for (int i = 0; i < N; ++i)
+      usage[i].assign(m_dhCacheSucc[i].size(), 0);
+
+   long removed = 0;
+
+   #pragma omp parallel for default(shared) schedule(dynamic, 1) reduction(+:removed)
+   for (int k = 0; k < K; ++k) {
+      // Trips reachable from the depot, and trips that can reach back the depot.
+      vector<char> fromDepot(N, 0), toDepot(N, 0);
+      for (int i: m_topoOrder) {
+         if (sourceCost(k, i) != -1)
+            fromDepot[i] = 1;
+         if (fromDepot[i]) {
+            for (auto &p: m_dhCacheSucc[i])
+               fromDepot[p.first] = 1;
+         }
+      }
+      for (auto it = m_topoOrder.rbegin(); it != m_topoOrder.rend(); ++it) {
+         if (sinkCost(k, *it) != -1) {
+            toDepot[*it] = 1;
+            continue;
+         }
+         for (auto &p: m_dhCacheSucc[*it]) {
+            if (toDepot[p.first]) {
+               toDepot[*it] = 1;
+               break;
+            }
+         }
+      }
+
+      // The capacity can not bind if every trip reachable from the depot could be 
+      // served by a vehicle on its own.
+      const bool capacityFree = depotCapacity(k) >= count(fromDepot.begin(), fromDepot.end(), 1);
+
+      auto isUseful = [&](int i, int j, int cost) -> bool {
+         if (!fromDepot[i] || !toDepot[j])
+            return false;
+         if (capacityFree) {
+            const auto sink = sinkCost(k, i);
+            const auto source = sourceCost(k, j);
+            if (sink != -1 && source != -1 && sink + source <= cost)
+               return false;
+         }
+         return true;
+      };
+
+      vector<vector<pair<int, int>>> depotSucc(N);
+      long depotRemoved = 0;
+      for (int i = 0; i < N; ++i) {
+         for (size_t pos = 0; pos < m_dhCacheSucc[i].size(); ++pos) {
+            const auto &p = m_dhCacheSucc[i][pos];
+            if (isUseful(i, p.first, p.second)) {
+               depotSucc[i].push_back(p);
+               #pragma omp atomic
+               ++usage[i][pos];
+            } else {
+               ++depotRemoved;
+            }
+         }
+      }
+
+      if (depotRemoved > 0) {
+         vector<vector<pair<int, int>>> depotPred(N);
+         for (int j = 0; j < N; ++j) {
+            depotSucc[j].shrink_to_fit();
+            for (auto &p: m_dhCachePred[j]) {
+               if (isUseful(p.first, j, p.second))
+                  depotPred[j].push_back(p);
+            }
+            depotPred[j].shrink_to_fit();
+         }
+         m_dhDepotSucc[k].swap(depotSucc);
+         m_dhDepotPred[k].swap(depotPred);
+      }
+      removed += depotRemoved;
+   }
+
+   // Arcs useless to every depot are removed from the instance data.
+   for (int i = 0; i < N; ++i) {
+      auto &succ = m_dhCacheSucc[i];
+      size_t keep = 0;
+      for (size_t pos = 0; pos < succ.size(); ++pos) {
+         if (usage[i][pos] > 0) {
+            succ[keep++] = succ[pos];
+         } else {
+            const int j = succ[pos].first;
+            m_matrix[m_numDepots + i][m_numDepots + j] = -1;
+            auto &pred = m_dhCachePred[j];
+            pred.erase(remove_if(pred.begin(), pred.end(), [&](const pair<int, int> &p) { return p.first == i; }), pred.end());
+         }
+      }
+      succ.resize(keep);
+   }
+
+   m_numDominatedArcs = removed;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -18,11 +19,17 @@ extern volatile bool MdvspSigInt;
 class Instance {
 public:
    /// Reads the instance from file.
-   Instance(const char *fname, bool sortDeadheadArcs = false);
+   /// If `preprocessArcs` is set, removes the deadhead arcs that are provably dominated
+   /// (see `preprocessDeadheadArcs`.)
+   Instance(const char *fname, bool sortDeadheadArcs = false, bool preprocessArcs = false);
    virtual ~Instance();
 
    auto fileName() const noexcept -> const std::string &;
 
+   /// Hash of the instance data as read from file, i.e., before any preprocessing.
+   /// Identifies the instance a set of columns was generated for.
+   auto fingerprint() const noexcept -> uint64_t;
+
    /// Data regarding the instance size.
    auto numDepots() const noexcept -> int;
    auto numTrips() const noexcept -> int;
@@ -41,9 +48,22 @@ public:
    auto deadheadSuccAdj(int pred) const noexcept -> const std::vector<std::pair<int, int>> &;
    auto deadheadPredAdj(int pred) const noexcept -> const std::vector<std::pair<int, int>> &;
 
+   // Same as above, but restricted to the arcs usable by vehicles of depot `k`.
+   auto deadheadSuccAdj(int k, int pred) const noexcept -> const std::vector<std::pair<int, int>> &;
+   auto deadheadPredAdj(int k, int succ) const noexcept -> const std::vector<std::pair<int, int>> &;
+   auto hasDeadheadArc(int k, int pred, int succ) const noexcept -> bool;
+
+   // Number of depot arcs removed by the preprocessing, i.e., pairs (depot, arc).
+   auto numDominatedArcs() const noexcept -> long;
+
+   // Returns the trips sorted in topological order of the deadhead arcs, i.e.,
+   // every trip appears after all its predecessors.
+   auto topologicalOrder() const noexcept -> const std::vector<int> &;
+
 private:
    const std::string m_fname;
    int m_numDepots, m_numTrips;
+   uint64_t m_fingerprint;
    
    // [depot ID] -> number of vehicles available
    std::vector<int> m_depotCap;
@@ -56,4 +76,20 @@ private:
    // <1> -> associated cost
    std::vector<std::vector<std::pair<int, int>>> m_dhCacheSucc;
    std::vector<std::vector<std::pair<int, int>>> m_dhCachePred;
+
+   // Trips in topological order of the deadheading network.
+   std::vector<int> m_topoOrder;
+
+   // Per-depot cache of the deadheading arcs. Only filled for depots where the 
+   // preprocessing removed some arc, otherwise the global cache is used.
+   std::vector<std::vector<std::vector<std::pair<int, int>>>> m_dhDepotSucc;
+   std::vector<std::vector<std::vector<std::pair<int, int>>>> m_dhDepotPred;
+   long m_numDominatedArcs{0};
+
+   // Removes the deadhead arcs that are not useful for some depot. An arc (i,j) is
+   // removed from depot k if i can not be reached from k, if j can not reach k, or
+   // if pulling in at k after i and pulling out from k to j costs no more than the 
+   // arc, and the capacity of k can never be binding. Arcs removed from all depots 
+   // are removed from the instance.
+   auto preprocessDeadheadArcs() noexcept -> void;
 };
@@ -1,132 +1,169 @@
 #include "ModelCbc.h"
 
 #include <algorithm>
+#include <cassert>
+#include <cstdio>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <string>
 
 #include <coin/OsiClpSolverInterface.hpp>
-#include <coin/CoinModel.hpp>
 
 using namespace std;
 
-ModelCbc::ModelCbc(const Instance &inst): m_inst(&inst) {
-   char buf[128];
-   CoinModel builder;
+ModelCbc::ModelCbc(const Instance &inst, const ArcFilter &isPresent): m_inst(&inst) {
+   const auto N = m_inst->numTrips();
+   const auto K = m_inst->numDepots();
+   const auto O = N;
+   const auto D = N + 1;
+   auto hasArc = [&](int k, int i, int j) {
+      return !isPresent || isPresent(k, i, j);
+   };
 
-   builder.setProblemName("compact_mdvsp_coin_cbc");
-   builder.setOptimizationDirection(1.0);
-
-   // Create the variables.
-   const auto N = m_inst->numTrips()+2;
-   const auto O = N-2;
-   const auto D = N-1;
-
-   m_x.resize(boost::extents[m_inst->numDepots()][N][N]);
-   fill_n(m_x.data(), m_x.num_elements(), -1);
+   // Marks the arcs of the model. Deadhead arcs are indexed by their position in 
+   // the adjacency lists of each depot.
+   m_srcCol.assign(K * N, -1);
+   m_sinkCol.assign(K * N, -1);
+   m_dhStart.assign(K * N + 1, 0);
+   for (int k = 0; k < K; ++k) {
+      for (int i = 0; i < N; ++i)
+         m_dhStart[k * N + i + 1] = m_dhStart[k * N + i] + m_inst->deadheadSuccAdj(k, i).size();
+   }
+   m_dhCol.assign(m_dhStart.back(), -1);
 
-   for (int i = 0; i < m_inst->numTrips(); ++i) {
-      // Creates source arcs.
-      for (int k = 0; k < m_inst->numDepots(); ++k) {
-         if (auto cost = m_inst->sourceCost(k, i); cost != -1) {
-            snprintf(buf, sizeof buf, "source#%d#%d#%d", k, O, i);
-            m_x[k][O][i] = builder.numberColumns();
-            builder.addColumn(0, nullptr, nullptr, 0.0, 1.0, cost, buf, true);
+   // [trip] -> number of arcs leaving the trip (or entering it, for source arcs).
+   vector<long> numCols(N + 1, 0), numEntries(N + 1, 0);
+   #pragma omp parallel for default(shared) schedule(dynamic, 64)
+   for (int i = 0; i < N; ++i) {
+      for (int k = 0; k < K; ++k) {
+         if (m_inst->sourceCost(k, i) != -1 && hasArc(k, O, i)) {
+            m_srcCol[k * N + i] = 0;
+            ++numCols[i + 1];
+            numEntries[i + 1] += 2;
          }
-      }
-
-      // Creates sink arcs.
-      for (int k = 0; k < m_inst->numDepots(); ++k) {
-         if (auto cost = m_inst->sinkCost(k, i); cost != -1) {
-            snprintf(buf, sizeof buf, "sink#%d#%d#%d", k, i, D);
-            m_x[k][i][D] = builder.numberColumns();
-            builder.addColumn(0, nullptr, nullptr, 0.0, 1.0, cost, buf, true);
+         if (m_inst->sinkCost(k, i) != -1 && hasArc(k, i, D)) {
+            m_sinkCol[k * N + i] = 0;
+            ++numCols[i + 1];
+            numEntries[i + 1] += 2;
          }
-      }
-
-      // Adds all deadheading arcs.
-      for (auto &p: m_inst->deadheadSuccAdj(i)) {
-         for (int k = 0; k < m_inst->numDepots(); ++k) {
-            snprintf(buf, sizeof buf, "deadhead#%d#%d#%d", k, i, p.first);
-            m_x[k][i][p.first] = builder.numberColumns();
-            builder.addColumn(0, nullptr, nullptr, 0.0, 1.0, p.second, buf, true);
+         const auto &succ = m_inst->deadheadSuccAdj(k, i);
+         for (size_t p = 0; p < succ.size(); ++p) {
+            if (hasArc(k, i, succ[p].first)) {
+               m_dhCol[m_dhStart[k * N + i] + p] = 0;
+               ++numCols[i + 1];
+               numEntries[i + 1] += 3;
+            }
          }
       }
    }
-   
-   // Adds the assignment constraints.
-   for (int i = 0; i < m_inst->numTrips(); ++i) {
-      vector <int> cols;
-      vector <double> coefs;
-
-      for (int k = 0; k < m_inst->numDepots(); ++k) {
-         for (auto &p: m_inst->deadheadSuccAdj(i)) {
-            auto colId = m_x[k][i][p.first];
-            assert(colId != -1);
-            cols.push_back(colId);
-            coefs.push_back(1.0);
-         }
-         if (auto colId = m_x[k][i][D]; colId != -1) {
-            cols.push_back(colId);
-            coefs.push_back(1.0);
+   partial_sum(numCols.begin(), numCols.end(), numCols.begin());
+   partial_sum(numEntries.begin(), numEntries.end(), numEntries.begin());
+
+   // Rows are the assignment constraints, one flow conservation constraint per 
+   // trip and depot, and the depot capacity constraints. In the reduced model, 
+   // flow conservation constraints without arcs are left out.
+   vector<int> flowRow(N * K, 0);
+   #pragma omp parallel for default(shared) schedule(dynamic, 64)
+   for (int i = 0; i < N; ++i) {
+      for (int k = 0; k < K; ++k) {
+         bool used = !isPresent || m_srcCol[k * N + i] != -1 || m_sinkCol[k * N + i] != -1;
+         for (long pos = m_dhStart[k * N + i]; !used && pos < m_dhStart[k * N + i + 1]; ++pos)
+            used = m_dhCol[pos] != -1;
+         for (auto &p: m_inst->deadheadPredAdj(k, i)) {
+            if (used)
+               break;
+            used = hasArc(k, p.first, i);
          }
+         flowRow[i * K + k] = used;
       }
-
-      snprintf(buf, sizeof buf, "assignment#%d", i);
-      builder.addRow(cols.size(), cols.data(), coefs.data(), 1.0, 1.0, buf);
    }
+   int numRows = N;
+   for (auto &row: flowRow)
+      row = row ? numRows++ : -1;
+   const int capRow = numRows;
+   numRows += K;
 
-   // Adds the flow conservation constraints.
-   for (int i = 0; i < m_inst->numTrips(); ++i) {
-      for (int k = 0; k < m_inst->numDepots(); ++k) {
-         vector<int> cols;
-         vector<double> coefs;
-
-         if (auto colId = m_x[k][O][i]; colId != -1) {
-            cols.push_back(colId);
-            coefs.push_back(1.0);
-         }
+   vector<double> rowLb(numRows, 0.0), rowUb(numRows, 0.0);
+   vector<string> rowNames(numRows);
+   for (int i = 0; i < N; ++i) {
+      rowLb[i] = rowUb[i] = 1.0;
+      rowNames[i] = "assignment#" + to_string(i);
+      for (int k = 0; k < K; ++k) {
+         if (flowRow[i * K + k] != -1)
+            rowNames[flowRow[i * K + k]] = "flow_consevation#" + to_string(k) + "#" + to_string(i);
+      }
+   }
+   for (int k = 0; k < K; ++k) {
+      rowLb[capRow + k] = -numeric_limits<double>::infinity();
+      rowUb[capRow + k] = m_inst->depotCapacity(k);
+      rowNames[capRow + k] = "depot_cap#" + to_string(k);
+   }
 
-         if (auto colId = m_x[k][i][D]; colId != -1) {
-            cols.push_back(colId);
-            coefs.push_back(-1.0);
+   // Creates the columns. The arcs leaving each trip are handled by a single
+   // thread, which knows where its columns start.
+   const int totalCols = numCols.back();
+   vector<CoinBigIndex> start(totalCols + 1);
+   vector<int> index(numEntries.back());
+   vector<double> value(numEntries.back()), obj(totalCols);
+   vector<string> colNames(totalCols);
+   start.back() = numEntries.back();
+   #pragma omp parallel for default(shared) schedule(dynamic, 64)
+   for (int i = 0; i < N; ++i) {
+      int col = numCols[i];
+      long entry = numEntries[i];
+      char buf[128];
+      auto addColumn = [&](double cost, initializer_list<pair<int, double>> entries) {
+         start[col] = entry;
+         obj[col] = cost;
+         colNames[col] = buf;
+         for (auto [row, coef]: entries) {
+            index[entry] = row;
+            value[entry++] = coef;
          }
+         return col++;
+      };
 
-         for (auto &p: m_inst->deadheadPredAdj(i)) {
-            auto colId = m_x[k][p.first][i];
-            assert(colId != -1);
-            cols.push_back(colId);
-            coefs.push_back(1.0);
+      // Creates source arcs.
+      for (int k = 0; k < K; ++k) {
+         if (auto &colId = m_srcCol[k * N + i]; colId != -1) {
+            snprintf(buf, sizeof buf, "source#%d#%d#%d", k, O, i);
+            colId = addColumn(m_inst->sourceCost(k, i), {{flowRow[i * K + k], 1.0}, {capRow + k, 1.0}});
          }
+      }
 
-         for (auto &p: m_inst->deadheadSuccAdj(i)) {
-            auto colId = m_x[k][i][p.first];
-            assert(colId != -1);
-            cols.push_back(colId);
-            coefs.push_back(-1.0);
+      // Creates sink arcs.
+      for (int k = 0; k < K; ++k) {
+         if (auto &colId = m_sinkCol[k * N + i]; colId != -1) {
+            snprintf(buf, sizeof buf, "sink#%d#%d#%d", k, i, D);
+            colId = addColumn(m_inst->sinkCost(k, i), {{i, 1.0}, {flowRow[i * K + k], -1.0}});
          }
+      }
 
-         snprintf(buf, sizeof buf, "flow_consevation#%d#%d", k, i);
-         builder.addRow(cols.size(), cols.data(), coefs.data(), 0.0, 0.0, buf);
-      }      
-   }
-
-   // Adds the depot capacity constraints.
-   for (int k = 0; k < m_inst->numDepots(); ++k) {
-      vector<int> cols;
-      vector<double> coefs;
-
-      for (int i = 0; i < m_inst->numTrips(); ++i) {
-         if (auto colId = m_x[k][O][i]; colId != -1) {
-            cols.push_back(colId);
-            coefs.push_back(1.0);
+      // Adds all deadheading arcs usable by each depot.
+      for (int k = 0; k < K; ++k) {
+         const auto &succ = m_inst->deadheadSuccAdj(k, i);
+         for (size_t p = 0; p < succ.size(); ++p) {
+            if (auto &colId = m_dhCol[m_dhStart[k * N + i] + p]; colId != -1) {
+               const int j = succ[p].first;
+               snprintf(buf, sizeof buf, "deadhead#%d#%d#%d", k, i, j);
+               colId = addColumn(succ[p].second, {{i, 1.0}, {flowRow[i * K + k], -1.0}, {flowRow[j * K + k], 1.0}});
+            }
          }
       }
-
-      snprintf(buf, sizeof buf, "depot_cap#%d", k);
-      builder.addRow(cols.size(), cols.data(), coefs.data(), -numeric_limits<double>::infinity(), m_inst->depotCapacity(k), buf);
    }
 
+   vector<double> colLb(totalCols, 0.0), colUb(totalCols, 1.0);
    m_lpSolver.reset(new OsiClpSolverInterface);
-   m_lpSolver->loadFromCoinModel(builder);
+   m_lpSolver->loadProblem(totalCols, numRows, start.data(), index.data(), value.data(), colLb.data(), colUb.data(), 
+      obj.data(), rowLb.data(), rowUb.data());
+   for (int row = 0; row < numRows; ++row)
+      m_lpSolver->setRowName(row, rowNames[row]);
+   for (int col = 0; col < totalCols; ++col)
+      m_lpSolver->setColName(col, colNames[col]);
+   vector<int> columns(totalCols);
+   iota(columns.begin(), columns.end(), 0);
+   m_lpSolver->setInteger(columns.data(), totalCols);
    m_model.reset(new CbcModel(*m_lpSolver));
 }
 
@@ -138,8 +175,82 @@ auto ModelCbc::writeLp(const char *fname) const noexcept -> void {
    m_lpSolver->writeLp(fname, "");
 }
 
+auto ModelCbc::arcColumn(int k, int i, int j) const noexcept -> int {
+   const auto N = m_inst->numTrips();
+   if (i == N)
+      return m_srcCol[k * N + j];
+   if (j == N + 1)
+      return m_sinkCol[k * N + i];
+
+   const auto &succ = m_inst->deadheadSuccAdj(k, i);
+   for (size_t p = 0; p < succ.size(); ++p) {
+      if (succ[p].first == j)
+         return m_dhCol[m_dhStart[k * N + i] + p];
+   }
+   return -1;
+}
+
 auto ModelCbc::changeBounds(int k, int i, int j, double lb, double ub) noexcept -> void {
-   auto colId = m_x[k][i][j];
+   auto colId = arcColumn(k, i, j);
    assert(colId != -1);
    m_lpSolver->setColBounds(colId, lb, ub);
 }
+
+auto ModelCbc::numColumns() const noexcept -> int {
+   return m_lpSolver->getNumCols();
+}
+
+auto ModelCbc::numRows() const noexcept -> int {
+   return m_lpSolver->getNumRows();
+}
+
+auto ModelCbc::setMipStart(const std::vector<std::pair<int, std::vector<int>>> &vehicles) noexcept -> bool {
+   const auto O = m_inst->numTrips();
+   const auto D = m_inst->numTrips() + 1;
+
+   vector<double> solution(m_lpSolver->getNumCols(), 0.0);
+   double cost = 0.0;
+   auto useArc = [&](int k, int i, int j) {
+      const auto colId = arcColumn(k, i, j);
+      if (colId == -1)
+         return false;
+      solution[colId] = 1.0;
+      cost += m_lpSolver->getObjCoefficients()[colId];
+      return true;
+   };
+
+   for (const auto &[k, trips]: vehicles) {
+      if (trips.empty() || !useArc(k, O, trips.front()) || !useArc(k, trips.back(), D))
+         return false;
+      for (size_t pos = 1; pos < trips.size(); ++pos) {
+         if (!useArc(k, trips[pos - 1], trips[pos]))
+            return false;
+      }
+   }
+
+   m_model->setBestSolution(solution.data(), solution.size(), cost, true);
+   return true;
+}
+
+auto ModelCbc::solve(int numThreads, double timeLimit) noexcept -> bool {
+   m_model->setLogLevel(1);
+   m_model->setNumberThreads(numThreads);
+   m_model->setMaximumSeconds(timeLimit);
+   m_model->initialSolve();
+   m_model->branchAndBound();
+   return m_model->isProvenOptimal();
+}
+
+auto ModelCbc::getObjValue() const noexcept -> double {
+   if (!m_model->bestSolution())
+      return numeric_limits<double>::infinity();
+   return m_model->getObjValue();
+}
+
+auto ModelCbc::getBestBound() const noexcept -> double {
+   return m_model->getBestPossibleObjValue();
+}
+
+auto ModelCbc::getNodeCount() const noexcept -> int {
+   return m_model->getNodeCount();
+}
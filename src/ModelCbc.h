@@ -2,22 +2,59 @@
 
 #include "Instance.h"
 
-#include <boost/multi_array.hpp>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include <coin/CbcModel.hpp>
 
 class ModelCbc {
 public:
-   ModelCbc(const Instance &inst);
+   // Decides whether the arc (i,j) of depot k is part of the model. Trips are numbered 
+   // from 0, the source node is numTrips(), and the sink node is numTrips()+1.
+   using ArcFilter = std::function<bool(int k, int i, int j)>;
+
+   // Builds the arc-flow model of the instance, in parallel. When `isPresent` is given, only
+   // the arcs it accepts are created, giving a reduced model. It must be safe to call
+   // `isPresent` from multiple threads.
+   ModelCbc(const Instance &inst, const ArcFilter &isPresent = nullptr);
    virtual ~ModelCbc();
 
    auto writeLp(const char *fname) const noexcept -> void;
 
    auto changeBounds(int k, int i, int j, double lb = 0.0, double ub = 1.0) noexcept -> void;
 
+   auto numColumns() const noexcept -> int;
+   auto numRows() const noexcept -> int;
+
+   // Passes a known solution to the solver, given as (depot, trips) vehicles. Returns false
+   // if the solution uses arcs not in the model.
+   auto setMipStart(const std::vector<std::pair<int, std::vector<int>>> &vehicles) noexcept -> bool;
+
+   // Solves the model with branch-and-cut. Returns true if optimality was proven.
+   auto solve(int numThreads, double timeLimit) noexcept -> bool;
+
+   // Results of solve(). The objective value is infinity when no solution was found.
+   auto getObjValue() const noexcept -> double;
+   auto getBestBound() const noexcept -> double;
+   auto getNodeCount() const noexcept -> int;
+
 private:
    const Instance *m_inst;
    std::unique_ptr<OsiClpSolverInterface> m_lpSolver;
-   boost::multi_array<int, 3> m_x;
+
+   // Columns of the arcs, or -1 when the arc is not in the model. Source and sink
+   // arcs are indexed by [k * numTrips() + trip]. The deadhead arcs leaving trip i
+   // of depot k are indexed by their position in deadheadSuccAdj(k, i), starting 
+   // from m_dhStart[k * numTrips() + i].
+   std::vector<int> m_srcCol;
+   std::vector<int> m_sinkCol;
+   std::vector<long> m_dhStart;
+   std::vector<int> m_dhCol;
 
    std::unique_ptr<CbcModel> m_model;   
+
+   // Column of the arc (i,j) of depot k, or -1.
+   auto arcColumn(int k, int i, int j) const noexcept -> int;
 };
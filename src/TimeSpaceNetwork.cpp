@@ -0,0 +1,139 @@
+#include "TimeSpaceNetwork.h"
+
+#include "Instance.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+using namespace std;
+
+TimeSpaceNetwork::TimeSpaceNetwork(const Instance &inst, const char *timetableFile): m_inst(&inst) {
+   ifstream fid(timetableFile);
+   if (!fid) {
+      cerr << "Timetable " << timetableFile << " could not be read.\n";
+      exit(EXIT_FAILURE);
+   }
+
+   int numTrips, numLocations, travelCost, waitCost;
+   fid >> numTrips >> numLocations >> travelCost >> waitCost;
+   if (numTrips != m_inst->numTrips() || numLocations <= 0) {
+      cerr << "Timetable " << timetableFile << " does not match the instance.\n";
+      exit(EXIT_FAILURE);
+   }
+
+   vector<int> startTime(numTrips), endTime(numTrips), startLoc(numTrips), endLoc(numTrips);
+   for (int i = 0; i < numTrips; ++i) {
+      fid >> startTime[i] >> endTime[i] >> startLoc[i] >> endLoc[i];
+      if (startLoc[i] < 0 || startLoc[i] >= numLocations || endLoc[i] < 0 || endLoc[i] >= numLocations) {
+         cerr << "Timetable " << timetableFile << " has invalid locations for trip " << i << ".\n";
+         exit(EXIT_FAILURE);
+      }
+   }
+
+   vector<vector<int>> travel(numLocations, vector<int>(numLocations));
+   for (auto &row: travel) {
+      for (auto &t: row)
+         fid >> t;
+   }
+
+   if (!fid) {
+      cerr << "Timetable " << timetableFile << " is truncated.\n";
+      exit(EXIT_FAILURE);
+   }
+
+   // Creates the waiting lines: one node per distinct departure time at each location.
+   // Arrival nodes of trips come first, so line nodes start at `numTrips`.
+   int numNodes = numTrips;
+   vector<map<int, int>> line(numLocations);
+   for (int j = 0; j < numTrips; ++j) {
+      auto &l = line[startLoc[j]];
+      if (l.find(startTime[j]) == l.end())
+         l[startTime[j]] = numNodes++;
+   }
+   m_out.resize(numNodes);
+
+   // Waiting arcs and trip arcs.
+   for (auto &l: line) {
+      for (auto it = l.begin(); it != l.end(); ++it) {
+         if (auto nx = next(it); nx != l.end()) {
+            m_out[it->second].push_back({nx->second, waitCost * (nx->first - it->first), -1});
+         }
+      }
+   }
+   for (int j = 0; j < numTrips; ++j) {
+      m_out[line[startLoc[j]][startTime[j]]].push_back({arrivalNode(j), 0, j});
+   }
+
+   // Deadhead arcs from the arrival of each trip to the first departure reachable at
+   // every location. They are sorted by cost, so a limit of label expansions keeps the
+   // cheapest connections.
+   for (int i = 0; i < numTrips; ++i) {
+      auto &arcs = m_out[arrivalNode(i)];
+      for (int l = 0; l < numLocations; ++l) {
+         const auto t = travel[endLoc[i]][l];
+         const auto arrival = endTime[i] + t;
+         if (auto it = line[l].lower_bound(arrival); it != line[l].end()) {
+            arcs.push_back({it->second, travelCost * t + waitCost * (it->first - arrival), -1});
+         }
+      }
+      stable_sort(arcs.begin(), arcs.end(), [](const Arc &a, const Arc &b) {
+         return a.cost < b.cost;
+      });
+   }
+
+   for (auto &arcs: m_out) {
+      arcs.shrink_to_fit();
+      m_numArcs += arcs.size();
+   }
+
+   // Topological order (Kahn's algorithm). Cycles only appear with inconsistent 
+   // timetables, e.g., trips with negative duration.
+   vector<int> inDegree(numNodes, 0);
+   for (auto &arcs: m_out) {
+      for (auto &a: arcs)
+         ++inDegree[a.head];
+   }
+   for (int v = 0; v < numNodes; ++v) {
+      if (inDegree[v] == 0)
+         m_topoOrder.push_back(v);
+   }
+   for (size_t pos = 0; pos < m_topoOrder.size(); ++pos) {
+      for (auto &a: m_out[m_topoOrder[pos]]) {
+         if (--inDegree[a.head] == 0)
+            m_topoOrder.push_back(a.head);
+      }
+   }
+   if ((int) m_topoOrder.size() != numNodes) {
+      cerr << "Timetable " << timetableFile << " yields a cyclic time-space network.\n";
+      exit(EXIT_FAILURE);
+   }
+}
+
+TimeSpaceNetwork::~TimeSpaceNetwork() {
+   // Empty
+}
+
+auto TimeSpaceNetwork::numNodes() const noexcept -> int {
+   return m_out.size();
+}
+
+auto TimeSpaceNetwork::numArcs() const noexcept -> long {
+   return m_numArcs;
+}
+
+auto TimeSpaceNetwork::arrivalNode(int trip) const noexcept -> int {
+   assert(trip >= 0 && trip < m_inst->numTrips());
+   return trip;
+}
+
+auto TimeSpaceNetwork::outArcs(int node) const noexcept -> const std::vector<Arc> & {
+   assert(node >= 0 && node < numNodes());
+   return m_out[node];
+}
+
+auto TimeSpaceNetwork::topologicalOrder() const noexcept -> const std::vector<int> & {
+   return m_topoOrder;
+}
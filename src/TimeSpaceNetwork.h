@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+class Instance;
+
+/**
+ * @brief Aggregated time-space network of the deadheading connections.
+ * 
+ * Instead of one arc per compatible pair of trips, the connections are represented
+ * implicitly by a waiting line per location. A line has one node per distinct 
+ * departure time of trips starting there, linked by waiting arcs. Each trip i has 
+ * an arrival node, from which deadhead arcs enter the line of every location at the 
+ * first departure reachable after traveling there. A trip j is entered from its 
+ * departure node in the line of its starting location. This gives O(n * locations)
+ * arcs instead of O(n^2).
+ * 
+ * Trip times and locations are not part of the instance format, so they are read 
+ * from a timetable file with the following layout:
+ * 
+ *    <num trips> <num locations> <travel cost per minute> <waiting cost per minute>
+ *    <start time> <end time> <start location> <end location>     (one line per trip)
+ *    <travel time matrix between locations>                      (locations x locations)
+ * 
+ * The cost of connecting trips i and j through the network is then 
+ * travelCost * travel + waitCost * (start_j - end_i - travel), following the 
+ * usual generator of MDVSP instances. instances/m3n80s0.timetable is the timetable
+ * of instances/m3n80s0.inp.
+ */
+class TimeSpaceNetwork {
+public:
+   struct Arc {
+      int head;
+      int cost;
+      // Trip covered by the arc, or -1 for waiting and deadhead arcs.
+      int trip;
+   };
+
+   TimeSpaceNetwork(const Instance &inst, const char *timetableFile);
+   virtual ~TimeSpaceNetwork();
+
+   auto numNodes() const noexcept -> int;
+   auto numArcs() const noexcept -> long;
+
+   // Arrival node of a trip. These are the first `numTrips` nodes of the network.
+   auto arrivalNode(int trip) const noexcept -> int;
+
+   // Outgoing arcs of a node.
+   auto outArcs(int node) const noexcept -> const std::vector<Arc> &;
+
+   // Nodes in topological order.
+   auto topologicalOrder() const noexcept -> const std::vector<int> &;
+
+private:
+   const Instance *m_inst;
+   std::vector<std::vector<Arc>> m_out;
+   std::vector<int> m_topoOrder;
+   long m_numArcs{0};
+};
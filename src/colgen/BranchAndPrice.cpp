@@ -0,0 +1,579 @@
+#include "BranchAndPrice.h"
+#include "CgMasterBase.h"
+#include "CgPricingBase.h"
+#include "TripChains.h"
+
+#include "Fnv.h"
+#include "Instance.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+
+#include <omp.h>
+
+using namespace std;
+
+// Tolerance used to consider a flow (or a column value) fractional.
+static constexpr double INTEGRALITY_EPS = 1e-6;
+
+// Heap order of the open nodes: best bound first, deepest first among ties.
+static auto isWorseNode = [](const auto &a, const auto &b) {
+   return a.bound > b.bound || (a.bound == b.bound && a.depth < b.depth);
+};
+
+BranchAndPrice::BranchAndPrice(const Instance &inst, MasterFactory makeMaster, PricingFactory makePricing, bool detectForced):
+   m_inst(&inst), m_makeMaster(move(makeMaster)), m_makePricing(move(makePricing)), m_detectForced(detectForced) {
+   m_incumbent = numeric_limits<double>::infinity();
+}
+
+BranchAndPrice::~BranchAndPrice() {
+   // Empty
+}
+
+auto BranchAndPrice::addColumns(const CgMasterBase &master) noexcept -> int {
+   int added = 0;
+   for (int col = 0; col < master.numColumns(); ++col)
+      added += addToPool(master.columnDepot(col), master.columnPath(col));
+   return added;
+}
+
+auto BranchAndPrice::setIncumbentValue(double value) noexcept -> void {
+   m_incumbent = value;
+}
+
+auto BranchAndPrice::setCheckpoint(const std::string &fname, double interval) noexcept -> void {
+   m_checkpointFile = fname;
+   m_checkpointInterval = interval;
+}
+
+auto BranchAndPrice::incumbentValue() const noexcept -> double {
+   return m_incumbent;
+}
+
+auto BranchAndPrice::lowerBound() const noexcept -> double {
+   return m_lowerBound;
+}
+
+auto BranchAndPrice::numNodes() const noexcept -> long {
+   return m_numNodes;
+}
+
+auto BranchAndPrice::numColumns() const noexcept -> int {
+   return m_poolDepot.size();
+}
+
+auto BranchAndPrice::incumbentSchedule() const noexcept -> const std::vector<Column> & {
+   return m_schedule;
+}
+
+auto BranchAndPrice::elapsed() const noexcept -> double {
+   return omp_get_wtime() - m_startTime;
+}
+
+auto BranchAndPrice::addToPool(int depot, const std::vector<int> &trips) noexcept -> bool {
+   const auto hash = fnv1a(trips.data(), trips.size() * sizeof(int), fnv1a(&depot, sizeof(depot)));
+
+   // Columns with the same hash are compared, so a collision does not drop a column.
+   auto [first, last] = m_poolHash.equal_range(hash);
+   for (auto it = first; it != last; ++it) {
+      const int c = it->second;
+      if (m_poolDepot[c] == depot && equal(trips.begin(), trips.end(), 
+            m_poolTrips.begin() + m_poolStart[c], m_poolTrips.begin() + m_poolStart[c + 1]))
+         return false;
+   }
+   m_poolHash.emplace(hash, m_poolDepot.size());
+   m_poolDepot.push_back(depot);
+   m_poolTrips.insert(m_poolTrips.end(), trips.begin(), trips.end());
+   m_poolStart.push_back(m_poolTrips.size());
+   return true;
+}
+
+auto BranchAndPrice::solve(int numThreads, double timeLimit) noexcept -> bool {
+   m_startTime = omp_get_wtime();
+   if (!m_finished && m_open.empty()) {
+      m_open.emplace_back();
+   }
+   m_running.clear();
+   m_running.resize(numThreads);
+
+   int active = 0;
+   bool stopping = false;
+   double lastLog = 0.0, lastCheckpoint = 0.0;
+
+   // Lower bound given by the open nodes and the nodes being processed.
+   auto openBound = [&]() {
+      double bound = m_incumbent;
+      for (const auto &node: m_open)
+         bound = min(bound, node.bound);
+      for (const auto &node: m_running) {
+         if (node)
+            bound = min(bound, node->bound);
+      }
+      return bound;
+   };
+
+   auto printLog = [&]() {
+      const double lb = openBound();
+      cout << fixed << setprecision(2) <<
+         "Nodes: " << setw(8) << m_numNodes <<
+         "   Open: " << setw(8) << m_open.size() + active <<
+         "   LB: " << setw(14) << lb <<
+         "   UB: " << setw(14) << double(m_incumbent) <<
+         "   Gap(%): " << setw(8) << (m_incumbent - lb) / m_incumbent * 100.0 <<
+         "   Cols: " << setw(10) << m_poolDepot.size() <<
+         "   Time: " << setw(10) << elapsed() << endl;
+   };
+
+   #pragma omp parallel default(shared) num_threads(numThreads)
+   {
+      const int tid = omp_get_thread_num();
+      Node node;
+      bool hasNode = false;
+      unique_ptr<Checkpoint> checkpoint;
+
+      for (;;) {
+         if (!hasNode) {
+            bool done = false;
+            #pragma omp critical(bpPool)
+            {
+               if (!m_open.empty() && !stopping) {
+                  pop_heap(m_open.begin(), m_open.end(), isWorseNode);
+                  node = move(m_open.back());
+                  m_open.pop_back();
+                  m_running[tid] = make_unique<Node>(node);
+                  hasNode = true;
+                  ++active;
+               } else if (active == 0 || stopping) {
+                  done = true;
+               }
+            }
+            if (done)
+               break;
+            if (!hasNode) {
+               // Waits for the other threads to branch.
+               this_thread::sleep_for(chrono::milliseconds(10));
+               continue;
+            }
+         }
+
+         Node dive, other;
+         auto status = NodeStatus::Pruned;
+         bool processed = false;
+         if (MdvspSigInt || elapsed() >= timeLimit) {
+            status = NodeStatus::Interrupted;
+         } else if (ceil(node.bound - 1e-6) < m_incumbent) {
+            status = processNode(node, dive, other, timeLimit);
+            processed = status != NodeStatus::Interrupted;
+         }
+
+         #pragma omp critical(bpPool)
+         {
+            if (status == NodeStatus::Interrupted)
+               stopping = true;
+            if (processed)
+               ++m_numNodes;
+
+            if (status == NodeStatus::Branched) {
+               m_open.push_back(move(other));
+               push_heap(m_open.begin(), m_open.end(), isWorseNode);
+               node = move(dive);
+               *m_running[tid] = node;
+            }
+
+            // Nodes interrupted, or not processed yet, stay open.
+            if (status == NodeStatus::Interrupted || (status == NodeStatus::Branched && stopping)) {
+               m_open.push_back(move(node));
+               push_heap(m_open.begin(), m_open.end(), isWorseNode);
+            }
+            if (status != NodeStatus::Branched || stopping) {
+               m_running[tid].reset();
+               hasNode = false;
+               --active;
+            }
+
+            if (elapsed() - lastLog >= 5.0) {
+               printLog();
+               lastLog = elapsed();
+            }
+            if (!m_checkpointFile.empty() && elapsed() - lastCheckpoint >= m_checkpointInterval) {
+               checkpoint = make_unique<Checkpoint>(checkpointState());
+               lastCheckpoint = elapsed();
+            }
+         }
+
+         if (checkpoint) {
+            #pragma omp critical(bpCheckpoint)
+            writeCheckpoint(*checkpoint);
+            checkpoint.reset();
+         }
+      }
+   }
+
+   m_finished = m_open.empty();
+   m_lowerBound = openBound();
+   printLog();
+   if (!m_checkpointFile.empty())
+      writeCheckpoint(checkpointState());
+
+   return m_finished;
+}
+
+auto BranchAndPrice::processNode(Node &node, Node &dive, Node &other, double timeLimit) noexcept -> NodeStatus {
+   const int N = m_inst->numTrips();
+   const int K = m_inst->numDepots();
+   TripChains chains(*m_inst, node.required, m_detectForced);
+
+   // Columns of the pool that agree with the branching decisions.
+   vector<int> reqNext(N, -1), reqPrev(N, -1);
+   for (auto [i, j]: node.required) {
+      reqNext[i] = j;
+      reqPrev[j] = i;
+   }
+   vector<pair<int, int>> forbidden(node.forbidden);
+   sort(forbidden.begin(), forbidden.end());
+   auto isCompatible = [&](const int *trips, int size) {
+      for (int pos = 0; pos < size; ++pos) {
+         const int t = trips[pos];
+         if (reqNext[t] != -1 && (pos + 1 == size || trips[pos + 1] != reqNext[t]))
+            return false;
+         if (reqPrev[t] != -1 && (pos == 0 || trips[pos - 1] != reqPrev[t]))
+            return false;
+         if (pos > 0 && binary_search(forbidden.begin(), forbidden.end(), make_pair(trips[pos - 1], t)))
+            return false;
+      }
+      return true;
+   };
+
+   vector<int> depots, start{0}, trips;
+   #pragma omp critical(bpPool)
+   {
+      for (size_t c = 0; c < m_poolDepot.size(); ++c) {
+         const int *path = &m_poolTrips[m_poolStart[c]];
+         const int size = m_poolStart[c + 1] - m_poolStart[c];
+         if (isCompatible(path, size)) {
+            depots.push_back(m_poolDepot[c]);
+            trips.insert(trips.end(), path, path + size);
+            start.push_back(trips.size());
+         }
+      }
+   }
+
+   auto master = m_makeMaster();
+   master->setTripChains(&chains);
+   master->addColumns(depots.size(), depots.data(), start.data(), trips.data());
+   master->setAssignmentType('E');
+   const int firstNew = master->numColumns();
+
+   vector<unique_ptr<CgPricingBase>> pricing;
+   for (int k = 0; k < K; ++k) {
+      pricing.emplace_back(m_makePricing(*master, k));
+      pricing.back()->setTripChains(&chains);
+      pricing.back()->removeDeadheadArcs(node.forbidden);
+   }
+
+   // Column generation up to optimality, unless the Lagrangian bound prunes the node.
+   auto status = NodeStatus::Branched;
+   double rmpObj = 0.0;
+   for (int iter = 0; ; ++iter) {
+      if (MdvspSigInt || elapsed() >= timeLimit) {
+         status = NodeStatus::Interrupted;
+         break;
+      }
+
+      rmpObj = master->solve(iter == 0 ? 'd' : 'p');
+      double lagrangianBound = rmpObj;
+      for (auto &sp: pricing) {
+         sp->solve();
+         lagrangianBound += m_inst->depotCapacity(sp->depotId()) * min(0.0, sp->getObjValue());
+      }
+      node.bound = max(node.bound, lagrangianBound);
+      if (ceil(node.bound - 1e-6) >= m_incumbent) {
+         status = NodeStatus::Pruned;
+         break;
+      }
+
+      int newCols = 0;
+      for (auto &sp: pricing) {
+         if (sp->getObjValue() <= -0.0001)
+            newCols += sp->generateColumns();
+      }
+      if (!newCols)
+         break;
+   }
+
+   #pragma omp critical(bpPool)
+   {
+      for (int col = firstNew; col < master->numColumns(); ++col)
+         addToPool(master->columnDepot(col), master->columnPath(col));
+   }
+   if (status != NodeStatus::Branched)
+      return status;
+
+   // The node is infeasible when some trip is covered by a dummy column.
+   vector<double> covered(N, 0.0);
+   unordered_map<long, double> flow;
+   for (int col = 0; col < master->numColumns(); ++col) {
+      const auto value = master->getValue(col);
+      if (value <= INTEGRALITY_EPS)
+         continue;
+      const auto &path = master->columnPath(col);
+      for (size_t pos = 0; pos < path.size(); ++pos) {
+         covered[path[pos]] += value;
+         if (pos > 0)
+            flow[long(path[pos - 1]) * N + path[pos]] += value;
+      }
+   }
+   for (int i = 0; i < N; ++i) {
+      if (covered[i] < 1.0 - INTEGRALITY_EPS)
+         return NodeStatus::Infeasible;
+   }
+
+   node.bound = max(node.bound, rmpObj);
+   if (ceil(node.bound - 1e-6) >= m_incumbent)
+      return NodeStatus::Pruned;
+
+   // Branches on the most fractional arc.
+   long bestArc = -1;
+   double bestFrac = INTEGRALITY_EPS, bestFlow = 0.0;
+   for (auto [arc, value]: flow) {
+      const double frac = min(value, 1.0 - value);
+      if (frac > bestFrac || (frac == bestFrac && bestArc != -1 && arc < bestArc)) {
+         bestArc = arc;
+         bestFrac = frac;
+         bestFlow = value;
+      }
+   }
+
+   if (bestArc != -1) {
+      const pair<int, int> arc(bestArc / N, bestArc % N);
+      Node down(node), up(node);
+      down.forbidden.push_back(arc);
+      up.required.push_back(arc);
+      down.depth = up.depth = node.depth + 1;
+
+      // Dives towards the side the flow is closer to.
+      if (bestFlow >= 0.5) {
+         dive = move(up);
+         other = move(down);
+      } else {
+         dive = move(down);
+         other = move(up);
+      }
+      return NodeStatus::Branched;
+   }
+
+   // Integral flows: splits the flow into vehicle blocks.
+   vector<int> succ(N, -1);
+   vector<char> hasPred(N, 0);
+   for (auto [arc, value]: flow) {
+      if (value > 0.5) {
+         succ[arc / N] = arc % N;
+         hasPred[arc % N] = 1;
+      }
+   }
+   vector<vector<int>> blocks;
+   for (int i = 0; i < N; ++i) {
+      if (hasPred[i])
+         continue;
+      blocks.emplace_back();
+      for (int t = i; t != -1; t = succ[t])
+         blocks.back().push_back(t);
+   }
+   assignBlocks(blocks);
+   return NodeStatus::Integral;
+}
+
+auto BranchAndPrice::assignBlocks(const std::vector<std::vector<int>> &blocks) noexcept -> void {
+   vector<int> depots, start{0}, trips;
+   for (const auto &block: blocks) {
+      for (int k = 0; k < m_inst->numDepots(); ++k) {
+         if (m_inst->sourceCost(k, block.front()) != -1 && m_inst->sinkCost(k, block.back()) != -1) {
+            depots.push_back(k);
+            trips.insert(trips.end(), block.begin(), block.end());
+            start.push_back(trips.size());
+         }
+      }
+   }
+
+   auto master = m_makeMaster();
+   master->setAssignmentType('E');
+   master->addColumns(depots.size(), depots.data(), start.data(), trips.data());
+   if (master->solve('d') >= 1e7)
+      return;
+
+   // The assignment is a transportation problem, so its basic solutions are integral.
+   vector<Column> schedule;
+   double cost = 0.0;
+   for (int col = 0; col < master->numColumns(); ++col) {
+      const auto value = master->getValue(col);
+      if (value > INTEGRALITY_EPS && value < 1.0 - INTEGRALITY_EPS)
+         return;
+      if (value > 0.5) {
+         schedule.push_back({master->columnDepot(col), master->columnPath(col)});
+         cost += master->getCost(col);
+      }
+   }
+
+   #pragma omp critical(bpPool)
+   {
+      if (cost < m_incumbent) {
+         m_incumbent = cost;
+         m_schedule.swap(schedule);
+         cout << "New incumbent: " << fixed << setprecision(2) << cost << " (" <<
+            m_schedule.size() << " vehicles) after " << elapsed() << " sec" << endl;
+      }
+   }
+}
+
+auto BranchAndPrice::checkpointState() const noexcept -> Checkpoint {
+   Checkpoint state;
+   state.incumbent = m_incumbent;
+   state.schedule = m_schedule;
+   state.poolDepot = m_poolDepot;
+   state.poolStart = m_poolStart;
+   state.poolTrips = m_poolTrips;
+   state.nodes = m_open;
+   for (const auto &node: m_running) {
+      if (node)
+         state.nodes.push_back(*node);
+   }
+   return state;
+}
+
+auto BranchAndPrice::writeCheckpoint(const Checkpoint &state) const noexcept -> void {
+   const auto tmpName = m_checkpointFile + ".tmp";
+   ofstream out(tmpName);
+   if (!out) {
+      cout << "WARNING: Could not write the checkpoint '" << m_checkpointFile << "'.\n";
+      return;
+   }
+
+   auto writeArcs = [&](const vector<pair<int, int>> &arcs) {
+      out << arcs.size();
+      for (auto [i, j]: arcs)
+         out << " " << i << " " << j;
+   };
+
+   out << setprecision(17);
+   out << "MDVSP-BP 1\n";
+   out << m_inst->fingerprint() << "\n";
+   out << (state.incumbent < numeric_limits<double>::infinity()) << " " <<
+      (state.incumbent < numeric_limits<double>::infinity() ? state.incumbent : 0.0) << "\n";
+   out << state.schedule.size() << "\n";
+   for (const auto &v: state.schedule) {
+      out << v.depot << " " << v.trips.size();
+      for (int t: v.trips)
+         out << " " << t;
+      out << "\n";
+   }
+   out << state.poolDepot.size() << "\n";
+   for (size_t c = 0; c < state.poolDepot.size(); ++c) {
+      out << state.poolDepot[c] << " " << state.poolStart[c + 1] - state.poolStart[c];
+      for (int pos = state.poolStart[c]; pos < state.poolStart[c + 1]; ++pos)
+         out << " " << state.poolTrips[pos];
+      out << "\n";
+   }
+
+   out << state.nodes.size() << "\n";
+   for (const auto &node: state.nodes) {
+      out << node.bound << " " << node.depth << " ";
+      writeArcs(node.forbidden);
+      out << " ";
+      writeArcs(node.required);
+      out << "\n";
+   }
+   out.close();
+
+   if (!out || rename(tmpName.c_str(), m_checkpointFile.c_str()) != 0)
+      cout << "WARNING: Could not write the checkpoint '" << m_checkpointFile << "'.\n";
+}
+
+auto BranchAndPrice::loadCheckpoint(const std::string &fname) noexcept -> bool {
+   ifstream in(fname);
+   string magic;
+   int version;
+   uint64_t fingerprint;
+   if (!(in >> magic >> version >> fingerprint) || magic != "MDVSP-BP" || version != 1) {
+      cout << "Bad checkpoint file '" << fname << "'.\n";
+      return false;
+   }
+   if (fingerprint != m_inst->fingerprint()) {
+      cout << "Checkpoint '" << fname << "' was written for another instance.\n";
+      return false;
+   }
+
+   const int N = m_inst->numTrips();
+   auto readColumn = [&](int &depot, vector<int> &trips) {
+      int size;
+      if (!(in >> depot >> size) || depot < 0 || depot >= m_inst->numDepots() || size <= 0 || size > N)
+         return false;
+      trips.resize(size);
+      for (auto &t: trips) {
+         if (!(in >> t) || t < 0 || t >= N)
+            return false;
+      }
+      return true;
+   };
+   auto readArcs = [&](vector<pair<int, int>> &arcs) {
+      size_t size;
+      // Down branches accumulate along a path, so a node may forbid more than N arcs.
+      if (!(in >> size) || size > size_t(N) * N)
+         return false;
+      arcs.resize(size);
+      for (auto &[i, j]: arcs) {
+         if (!(in >> i >> j) || i < 0 || i >= N || j < 0 || j >= N)
+            return false;
+      }
+      return true;
+   };
+
+   bool ok = true;
+   int hasIncumbent;
+   double incumbent;
+   size_t count = 0;
+   vector<Column> schedule;
+   ok = ok && (in >> hasIncumbent >> incumbent >> count);
+   for (size_t v = 0; ok && v < count; ++v) {
+      schedule.emplace_back();
+      ok = readColumn(schedule.back().depot, schedule.back().trips);
+   }
+
+   ok = ok && (in >> count);
+   int depot;
+   vector<int> trips;
+   for (size_t c = 0; ok && c < count; ++c) {
+      ok = readColumn(depot, trips);
+      if (ok)
+         addToPool(depot, trips);
+   }
+
+   vector<Node> nodes;
+   ok = ok && (in >> count);
+   for (size_t n = 0; ok && n < count; ++n) {
+      nodes.emplace_back();
+      ok = (in >> nodes.back().bound >> nodes.back().depth) &&
+         readArcs(nodes.back().forbidden) && readArcs(nodes.back().required);
+   }
+
+   if (!ok) {
+      cout << "Bad checkpoint file '" << fname << "'.\n";
+      return false;
+   }
+
+   if (hasIncumbent && incumbent < m_incumbent) {
+      m_incumbent = incumbent;
+      m_schedule.swap(schedule);
+   }
+   m_open.swap(nodes);
+   make_heap(m_open.begin(), m_open.end(), isWorseNode);
+   m_finished = m_open.empty();
+   return true;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Instance;
+class CgMasterBase;
+class CgPricingBase;
+
+/**
+ * @brief Branch-and-price for the MDVSP.
+ *
+ * Each node is solved by column generation, up to optimality, starting from the
+ * columns of a pool shared by all nodes. Branching is done on the flow of a deadhead
+ * arc (i,j), summed over all depots. The down branch removes the arc from the pricing
+ * subproblems, and the up branch adds the arc into the trip chains, so trip i is
+ * always followed by trip j. Columns of the pool that disagree with the branching
+ * decisions are left out of the master problem of the node.
+ *
+ * When all arc flows are integral, the vehicle blocks are fixed, and what remains is
+ * assigning blocks to depots. This is a transportation problem, whose LP solution is
+ * integral, so it gives the best solution of the node.
+ *
+ * Nodes are processed by a pool of threads, each one building its own master problem
+ * and subproblems. A thread dives into one of the children of its node, and leaves
+ * the other in the pool of open nodes, from which the node with the best bound is
+ * taken next. Since the trip chains must enforce the up branches, only the spfa and
+ * bellman subproblems are supported.
+ */
+class BranchAndPrice {
+public:
+   using MasterFactory = std::function<std::unique_ptr<CgMasterBase>()>;
+   using PricingFactory = std::function<std::unique_ptr<CgPricingBase>(CgMasterBase &rmp, int depotId)>;
+
+   struct Column {
+      int depot;
+      std::vector<int> trips;
+   };
+
+   // When `detectForced` is set, the forced trip sequences of the instance are
+   // contracted along with the arcs fixed by branching.
+   BranchAndPrice(const Instance &inst, MasterFactory makeMaster, PricingFactory makePricing, bool detectForced);
+   virtual ~BranchAndPrice();
+
+   // Adds the columns of a master problem into the pool.
+   auto addColumns(const CgMasterBase &master) noexcept -> int;
+
+   // Value of a known solution. Nodes that can not improve it are pruned.
+   auto setIncumbentValue(double value) noexcept -> void;
+
+   // Periodically saves the search into `fname`, every `interval` seconds, and when
+   // the search stops. The file keeps the open nodes, the incumbent, and the pool.
+   auto setCheckpoint(const std::string &fname, double interval) noexcept -> void;
+
+   // Restores a search saved by a checkpoint. Returns false if the file can not be
+   // read, or was written for another instance.
+   auto loadCheckpoint(const std::string &fname) noexcept -> bool;
+
+   // Runs the search with `numThreads` workers, until optimality is proven or the time
+   // limit is reached. Returns true if the search finished.
+   auto solve(int numThreads, double timeLimit) noexcept -> bool;
+
+   auto incumbentValue() const noexcept -> double;
+   auto lowerBound() const noexcept -> double;
+   auto numNodes() const noexcept -> long;
+   auto numColumns() const noexcept -> int;
+
+   // Vehicles of the best solution found by the search. Empty if the search has not
+   // improved the incumbent value.
+   auto incumbentSchedule() const noexcept -> const std::vector<Column> &;
+
+private:
+   struct Node {
+      std::vector<std::pair<int, int>> forbidden;  // arcs removed by down branches
+      std::vector<std::pair<int, int>> required;   // arcs forced by up branches
+      double bound{0.0};
+      int depth{0};
+   };
+
+   enum class NodeStatus {Pruned, Infeasible, Branched, Integral, Interrupted};
+
+   const Instance *m_inst;
+   MasterFactory m_makeMaster;
+   PricingFactory m_makePricing;
+   bool m_detectForced;
+
+   // Shared pool of columns, stored as in CgMasterBase::addColumns().
+   std::vector<int> m_poolDepot;
+   std::vector<int> m_poolStart{0};
+   std::vector<int> m_poolTrips;
+   // Hash of (depot, trips) -> columns of the pool with that hash.
+   std::unordered_multimap<uint64_t, int> m_poolHash;
+
+   // Open nodes, kept as a heap ordered by bound.
+   std::vector<Node> m_open;
+   // [thread] -> node being processed, if any.
+   std::vector<std::unique_ptr<Node>> m_running;
+
+   std::atomic<double> m_incumbent;
+   std::vector<Column> m_schedule;
+   double m_lowerBound{0.0};
+   long m_numNodes{0};
+   bool m_finished{false};
+
+   std::string m_checkpointFile;
+   double m_checkpointInterval{0.0};
+   double m_startTime{0.0};
+
+   // Solves a node by column generation. When branching, `dive` receives the child
+   // the thread continues with, and `other` the child left in the pool.
+   auto processNode(Node &node, Node &dive, Node &other, double timeLimit) noexcept -> NodeStatus;
+
+   // Solves the assignment of vehicle blocks to depots. Updates the incumbent.
+   auto assignBlocks(const std::vector<std::vector<int>> &blocks) noexcept -> void;
+
+   // Adds a column into the pool, unless it is already there. Must be called
+   // within the pool critical section.
+   auto addToPool(int depot, const std::vector<int> &trips) noexcept -> bool;
+
+   // State saved by a checkpoint. It is copied within the pool critical section, so
+   // the file is written while the other threads go on.
+   struct Checkpoint {
+      double incumbent;
+      std::vector<Column> schedule;
+      std::vector<int> poolDepot;
+      std::vector<int> poolStart;
+      std::vector<int> poolTrips;
+      std::vector<Node> nodes;
+   };
+
+   // Copies the state of the search. Must be called within the pool critical section.
+   auto checkpointState() const noexcept -> Checkpoint;
+   auto writeCheckpoint(const Checkpoint &state) const noexcept -> void;
+   auto elapsed() const noexcept -> double;
+};
@@ -1,11 +1,42 @@
 #include "CgMasterBase.h"
 
+#include "Fnv.h"
 #include "Instance.h"
+#include "TripChains.h"
 #include <cassert>
+#include <cstring>
 #include <fstream>
+#include <iostream>
+#include <set>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
+namespace {
+   // Layout of binary column pools. The header is followed by the arrays
+   // depots[numCols], start[numCols+1], trips[numEntries] (all int32), and
+   // costs[numCols] (double). The checksum covers all the arrays.
+   constexpr char ColumnPoolMagic[8] = {'M', 'D', 'V', 'S', 'P', 'C', 'O', 'L'};
+   constexpr uint32_t ColumnPoolVersion = 1;
+
+   struct ColumnPoolHeader {
+      char magic[8];
+      uint32_t version{ColumnPoolVersion};
+      int32_t numDepots;
+      int32_t numTrips;
+      int32_t reserved{0};
+      uint64_t fingerprint;
+      int64_t numCols;
+      int64_t numEntries;
+      uint64_t checksum;
+   };
+   static_assert(sizeof(ColumnPoolHeader) == 56, "Unexpected padding in the column pool header");
+}
+
 CgMasterBase::CgMasterBase(const Instance &inst): m_inst(&inst) {
    m_newcolDepot = -1;
    m_newcolCost = std::numeric_limits<double>::infinity();
@@ -26,21 +57,12 @@ auto CgMasterBase::beginColumn(int depotId) noexcept -> void {
 
 auto CgMasterBase::addTrip(int trip) noexcept -> void {
    assert(trip >= 0 && trip < m_inst->numTrips());
-   if (m_newcolLastTrip == -1) {
-      assert(m_inst->sourceCost(m_newcolDepot, trip) != -1);
-      m_newcolCost += m_inst->sourceCost(m_newcolDepot, trip);
-   } else {
-      assert(m_inst->deadheadCost(m_newcolLastTrip, trip) != -1);
-      m_newcolCost += m_inst->deadheadCost(m_newcolLastTrip, trip);
-   }
    m_newcolPath.push_back(trip);
    m_newcolLastTrip = trip;
 }
 
 auto CgMasterBase::commitColumn() noexcept -> void {
-   assert(m_newcolLastTrip != -1);
-   assert(m_inst->sinkCost(m_newcolDepot, m_newcolLastTrip) != -1);
-   m_newcolCost += m_inst->sinkCost(m_newcolDepot, m_newcolLastTrip);
+   prepareColumn();
    addColumn();
    ++m_numCols;
 
@@ -49,6 +71,90 @@ auto CgMasterBase::commitColumn() noexcept -> void {
    m_colCost.push_back(m_newcolCost);
 }
 
+auto CgMasterBase::addColumns(int numCols, const int *depots, const int *start, const int *trips, const double *costs) noexcept -> int {
+   const int first = m_colDepot.size();
+
+   // Columns with known costs need neither the chain expansion nor the cost
+   // computation of prepareColumn.
+   if (costs && !m_chains) {
+      m_colTrips.reserve(first + numCols);
+      m_colDepot.insert(m_colDepot.end(), depots, depots + numCols);
+      for (int c = 0; c < numCols; ++c)
+         m_colTrips.emplace_back(trips + start[c], trips + start[c + 1]);
+      m_colCost.insert(m_colCost.end(), costs, costs + numCols);
+
+      addColumnsBulk(first);
+      m_numCols = m_colDepot.size();
+      return numCols;
+   }
+
+   for (int c = 0; c < numCols; ++c) {
+      beginColumn(depots[c]);
+      for (int pos = start[c]; pos < start[c + 1]; ++pos)
+         addTrip(trips[pos]);
+      prepareColumn();
+
+      m_colDepot.push_back(m_newcolDepot);
+      m_colTrips.push_back(m_newcolPath);
+      m_colCost.push_back(m_newcolCost);
+   }
+
+   addColumnsBulk(first);
+   m_numCols = m_colDepot.size();
+   return numCols;
+}
+
+auto CgMasterBase::addColumnsBulk(int first) noexcept -> void {
+   for (int c = first; c < int(m_colDepot.size()); ++c) {
+      m_newcolDepot = m_colDepot[c];
+      m_newcolPath = m_colTrips[c];
+      m_newcolCost = m_colCost[c];
+      addColumn();
+      ++m_numCols;
+   }
+}
+
+auto CgMasterBase::prepareColumn() noexcept -> void {
+   assert(m_newcolLastTrip != -1);
+
+   // Expands the chains of forced trips. Trips already followed by their
+   // forced successor are kept as they are.
+   if (m_chains) {
+      vector<int> expanded;
+      expanded.reserve(m_newcolPath.size());
+      for (size_t pos = 0; pos < m_newcolPath.size(); ++pos) {
+         int trip = m_newcolPath[pos];
+         expanded.push_back(trip);
+         const int nextTrip = pos + 1 < m_newcolPath.size() ? m_newcolPath[pos + 1] : -1;
+         while (m_chains->next(trip) != -1 && m_chains->next(trip) != nextTrip) {
+            trip = m_chains->next(trip);
+            expanded.push_back(trip);
+         }
+      }
+      m_newcolPath.swap(expanded);
+      m_newcolLastTrip = m_newcolPath.back();
+   }
+
+   // Computes the cost of the path.
+   int prev = -1;
+   for (int trip: m_newcolPath) {
+      if (prev == -1) {
+         assert(m_inst->sourceCost(m_newcolDepot, trip) != -1);
+         m_newcolCost += m_inst->sourceCost(m_newcolDepot, trip);
+      } else {
+         assert(m_inst->deadheadCost(prev, trip) != -1);
+         m_newcolCost += m_inst->deadheadCost(prev, trip);
+      }
+      prev = trip;
+   }
+   assert(m_inst->sinkCost(m_newcolDepot, m_newcolLastTrip) != -1);
+   m_newcolCost += m_inst->sinkCost(m_newcolDepot, m_newcolLastTrip);
+}
+
+auto CgMasterBase::setTripChains(const TripChains *chains) noexcept -> void {
+   m_chains = chains;
+}
+
 auto CgMasterBase::numColumns() const noexcept -> int {
    return m_numCols;
 }
@@ -65,27 +171,227 @@ auto CgMasterBase::exportColumns(const char *fname) const noexcept -> void {
    }
 }
 
+auto CgMasterBase::exportColumnsBinary(const char *fname) const noexcept -> void {
+   ColumnPoolHeader header;
+   memcpy(header.magic, ColumnPoolMagic, sizeof header.magic);
+   header.fingerprint = m_inst->fingerprint();
+   header.numDepots = m_inst->numDepots();
+   header.numTrips = m_inst->numTrips();
+   header.numCols = m_colDepot.size();
+
+   vector<int32_t> start{0}, trips;
+   for (const auto &path: m_colTrips) {
+      trips.insert(trips.end(), path.begin(), path.end());
+      start.push_back(trips.size());
+   }
+   header.numEntries = trips.size();
+
+   const vector<int32_t> depots(m_colDepot.begin(), m_colDepot.end());
+   uint64_t checksum = fnv1a(depots.data(), depots.size() * sizeof(int32_t));
+   checksum = fnv1a(start.data(), start.size() * sizeof(int32_t), checksum);
+   checksum = fnv1a(trips.data(), trips.size() * sizeof(int32_t), checksum);
+   checksum = fnv1a(m_colCost.data(), m_colCost.size() * sizeof(double), checksum);
+   header.checksum = checksum;
+
+   ofstream fid(fname, ios::binary);
+   if (!fid) abort();
+   fid.write(reinterpret_cast<const char *>(&header), sizeof header);
+   fid.write(reinterpret_cast<const char *>(depots.data()), depots.size() * sizeof(int32_t));
+   fid.write(reinterpret_cast<const char *>(start.data()), start.size() * sizeof(int32_t));
+   fid.write(reinterpret_cast<const char *>(trips.data()), trips.size() * sizeof(int32_t));
+   fid.write(reinterpret_cast<const char *>(m_colCost.data()), m_colCost.size() * sizeof(double));
+   if (!fid) abort();
+}
+
 auto CgMasterBase::importColumns(const char *fname) noexcept -> int {
    ifstream fid(fname);
    if (!fid) abort();
 
+   char magic[sizeof ColumnPoolHeader::magic];
+   if (fid.read(magic, sizeof magic) && memcmp(magic, ColumnPoolMagic, sizeof magic) == 0) {
+      fid.close();
+      return importColumnsBinary(fname);
+   }
+   fid.clear();
+   fid.seekg(0);
+
    int nc;
    fid >> nc;
+   vector<int> depots(nc), start{0}, trips;
    for (int i = 0; i < nc; ++i) {
-      int depot, nt;
-      fid >> depot >> nt;
-      beginColumn(depot);
+      int nt;
+      fid >> depots[i] >> nt;
       for (int j = 0; j < nt; ++j) {
          int t;
          fid >> t;
-         addTrip(t);
+         trips.push_back(t);
       }
-      commitColumn();
+      start.push_back(trips.size());
    }
    
+   return addColumns(nc, depots.data(), start.data(), trips.data());
+}
+
+auto CgMasterBase::importColumnsBinary(const char *fname) noexcept -> int {
+   auto fail = [&](const char *reason) -> void {
+      cerr << "Could not import columns from " << fname << ": " << reason << ".\n";
+      abort();
+   };
+
+   const int fd = open(fname, O_RDONLY);
+   if (fd == -1) 
+      fail("file could not be opened");
+   struct stat st;
+   if (fstat(fd, &st) == -1 || size_t(st.st_size) < sizeof(ColumnPoolHeader))
+      fail("truncated header");
+   const size_t size = st.st_size;
+   void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (data == MAP_FAILED)
+      fail("file could not be mapped");
+
+   // Validates the header before touching the columns.
+   ColumnPoolHeader header;
+   memcpy(&header, data, sizeof header);
+   if (header.version != ColumnPoolVersion)
+      fail("unsupported version");
+   if (header.fingerprint != m_inst->fingerprint() || header.numDepots != m_inst->numDepots() || header.numTrips != m_inst->numTrips())
+      fail("columns were generated for a different instance");
+   if (header.numCols < 0 || header.numEntries < 0 || header.numCols > INT32_MAX || header.numEntries > INT32_MAX)
+      fail("corrupted header");
+   const size_t expectedSize = sizeof header + 
+      (2 * header.numCols + 1 + header.numEntries) * sizeof(int32_t) + 
+      header.numCols * sizeof(double);
+   if (size != expectedSize)
+      fail("unexpected file size");
+
+   const auto base = static_cast<const char *>(data) + sizeof header;
+   const auto depots = reinterpret_cast<const int32_t *>(base);
+   const auto start = depots + header.numCols;
+   const auto trips = start + header.numCols + 1;
+   
+   if (fnv1a(base, size - sizeof header) != header.checksum)
+      fail("checksum mismatch");
+
+   // Checks the structure of the columns, so the master gets valid data only.
+   if (start[0] != 0 || start[header.numCols] != header.numEntries)
+      fail("corrupted column starts");
+   for (int64_t c = 0; c < header.numCols; ++c) {
+      if (depots[c] < 0 || depots[c] >= m_inst->numDepots() || start[c + 1] <= start[c])
+         fail("corrupted column");
+   }
+   for (int64_t pos = 0; pos < header.numEntries; ++pos) {
+      if (trips[pos] < 0 || trips[pos] >= m_inst->numTrips())
+         fail("corrupted trip id");
+   }
+
+   // The costs follow the trips, which may leave them unaligned for doubles.
+   vector<double> costs(header.numCols);
+   memcpy(costs.data(), trips + header.numEntries, header.numCols * sizeof(double));
+
+   const int nc = addColumns(header.numCols, depots, start, trips, costs.data());
+   munmap(data, size);
    return nc;
 }
 
+auto CgMasterBase::warmStartColumns(const char *fname, const std::vector<int> &tripMap) noexcept -> WarmStartStats {
+   ifstream fid(fname);
+   if (!fid) abort();
+
+   const int N = m_inst->numTrips();
+   const int K = m_inst->numDepots();
+   auto mapTrip = [&](int t) -> int {
+      if (tripMap.empty())
+         return t >= 0 && t < N ? t : -1;
+      const int mapped = t >= 0 && t < int(tripMap.size()) ? tripMap[t] : -1;
+      return mapped >= 0 && mapped < N ? mapped : -1;
+   };
+
+   WarmStartStats stats;
+   set<pair<int, vector<int>>> seen;
+   vector<int> depots, start{0}, trips;
+   vector<int> path, segment;
+
+   // Adds the valid part of a segment: trims the trips the depot cannot 
+   // start or finish with.
+   auto flushSegment = [&](int k) -> bool {
+      auto first = segment.begin(), last = segment.end();
+      while (first != last && m_inst->sourceCost(k, *first) == -1)
+         ++first;
+      while (first != last && m_inst->sinkCost(k, *(last - 1)) == -1)
+         --last;
+      const bool trimmed = first != segment.begin() || last != segment.end();
+      if (first != last && seen.emplace(k, vector<int>(first, last)).second) {
+         depots.push_back(k);
+         trips.insert(trips.end(), first, last);
+         start.push_back(trips.size());
+      }
+      segment.clear();
+      return trimmed;
+   };
+
+   int nc;
+   fid >> nc;
+   for (int i = 0; i < nc; ++i) {
+      int depot, nt;
+      fid >> depot >> nt;
+      path.resize(nt);
+      for (int j = 0; j < nt; ++j)
+         fid >> path[j];
+      ++stats.read;
+
+      if (depot < 0 || depot >= K) {
+         ++stats.dropped;
+         continue;
+      }
+
+      // Maps the trips into the new instance and splits the path wherever
+      // the connection no longer exists.
+      const int before = depots.size();
+      bool broken = false;
+      for (int t: path) {
+         const int mapped = mapTrip(t);
+         if (mapped == -1) {
+            broken = true;
+            continue;
+         }
+         if (!segment.empty() && !m_inst->hasDeadheadArc(depot, segment.back(), mapped)) {
+            broken = true;
+            flushSegment(depot);
+         }
+         segment.push_back(mapped);
+      }
+      broken |= flushSegment(depot);
+
+      if (int(depots.size()) == before && broken)
+         ++stats.dropped;
+      else if (broken)
+         ++stats.repaired;
+   }
+
+   stats.loaded = addColumns(depots.size(), depots.data(), start.data(), trips.data());
+   return stats;
+}
+
+auto CgMasterBase::syncWith(const CgMasterBase &source) noexcept -> void {
+   assert(source.m_inst == m_inst && source.numColumns() >= numColumns());
+   const int first = numColumns();
+   if (const int nc = source.numColumns() - first; nc > 0) {
+      vector<int> start{0}, trips;
+      for (int c = first; c < source.numColumns(); ++c) {
+         const auto &path = source.m_colTrips[c];
+         trips.insert(trips.end(), path.begin(), path.end());
+         start.push_back(trips.size());
+      }
+      addColumns(nc, source.m_colDepot.data() + first, start.data(), trips.data(), source.m_colCost.data() + first);
+   }
+
+   for (int col = 0; col < numColumns(); ++col) {
+      if (const auto lb = source.getLb(col); lb != getLb(col))
+         setLb(col, lb);
+   }
+}
+
 auto CgMasterBase::columnDepot(int col) const noexcept -> int {
    return m_colDepot[col];
 }
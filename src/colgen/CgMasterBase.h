@@ -1,9 +1,11 @@
 #pragma once 
 
+#include <memory>
 #include <vector>
 #include <iosfwd>
 
 class Instance;
+class TripChains;
 
 /**
  * @brief Base class for implementing a Master Problem.
@@ -16,7 +18,26 @@ public:
    virtual auto getSolverName() const noexcept -> std::string = 0;
    virtual auto writeLp(const char *fname) const noexcept -> void = 0;
 
+   // Creates an independent copy of the master problem, including its columns
+   // and column bounds. Used to run dives in parallel.
+   virtual auto clone() const noexcept -> std::unique_ptr<CgMasterBase> = 0;
+
    virtual auto solve(const char algo = 'p') noexcept -> double = 0;
+
+   // Sets an upper limit for the objective when solving with the dual simplex. Once 
+   // the limit is exceeded, the solve stops and returns a value of at least `limit`.
+   // Use infinity to remove the limit.
+   virtual auto setObjLimit(double limit) noexcept -> void = 0;
+
+   // Snapshot of the simplex basis, used to warm start the solver after reverting
+   // column bounds. The statuses are solver specific. When restoring a snapshot, the
+   // columns added after it was taken are made non-basic at their lower bounds.
+   struct Basis {
+      std::vector<int> rowStatus;
+      std::vector<int> colStatus;
+   };
+   virtual auto getBasis() const noexcept -> Basis = 0;
+   virtual auto setBasis(const Basis &basis) noexcept -> void = 0;
    virtual auto getObjValue() const noexcept -> double = 0;
    virtual auto getTripDual(int i) const noexcept -> double = 0;
    virtual auto getDepotCapDual(int k) const noexcept -> double = 0;
@@ -26,6 +47,16 @@ public:
    virtual auto addTrip(int trip) noexcept -> void;
    virtual auto commitColumn() noexcept -> void;
 
+   // Adds a batch of `numCols` columns at once. The trips of column `c` are stored in
+   // trips[start[c]] ... trips[start[c+1]-1]. When `costs` is given and no chains are
+   // set, the columns are taken as they are, so their trips are copied in one block each
+   // and their costs are not recomputed. Returns the number of columns added.
+   auto addColumns(int numCols, const int *depots, const int *start, const int *trips, const double *costs = nullptr) noexcept -> int;
+
+   // Sets the contraction of forced trip sequences used by the pricing. When set,
+   // the columns are expanded with the forced successors of their trips when committed.
+   auto setTripChains(const TripChains *chains) noexcept -> void;
+
    // Queries how many columns exists in the RRMP
    auto numColumns() const noexcept -> int;
 
@@ -36,9 +67,29 @@ public:
    virtual auto setAssignmentType(char sense = 'G') noexcept -> void = 0;
 
    // Capability of exporting/importing columns from file.
+   // The text format is meant for interchange. The binary format stores the 
+   // fingerprint of the instance, and a checksum of the columns, which are
+   // verified on import. importColumns() detects the format of the file.
    auto exportColumns(const char *fname) const noexcept -> void;
+   auto exportColumnsBinary(const char *fname) const noexcept -> void;
    auto importColumns(const char *fname) noexcept -> int;
 
+   // Imports the columns of a previous run on a modified timetable. `tripMap`
+   // maps the old trip ids into the new ones (-1 for removed trips); when empty,
+   // trips keep their ids. Columns are split wherever a connection no longer 
+   // exists, and trimmed to trips their depot can start and finish with.
+   struct WarmStartStats {
+      int read{0};      // columns in the file
+      int repaired{0};  // columns that had to be split or trimmed
+      int dropped{0};   // columns with nothing left to load
+      int loaded{0};    // columns added into the master problem
+   };
+   auto warmStartColumns(const char *fname, const std::vector<int> &tripMap) noexcept -> WarmStartStats;
+
+   // Brings a copy of `source` up to date: adds the columns created after the
+   // copy was made, and copies the lower bounds of the columns.
+   auto syncWith(const CgMasterBase &source) noexcept -> void;
+
    // Query column data from the master problem.
    auto columnDepot(int col) const noexcept -> int;
    auto columnPath(int col) const noexcept -> const std::vector<int>&;
@@ -59,6 +110,7 @@ public:
 
 protected:
    const Instance *m_inst;
+   const TripChains *m_chains{nullptr};
    int m_numCols{0};
 
    // Items for caching elements of a new column.
@@ -73,4 +125,14 @@ protected:
    std::vector<double> m_colCost;
 
    virtual auto addColumn() noexcept -> void = 0;
+
+   // Adds the cached columns from `first` onwards into the solver. The default
+   // implementation calls addColumn() once per column.
+   virtual auto addColumnsBulk(int first) noexcept -> void;
+
+private:
+   auto importColumnsBinary(const char *fname) noexcept -> int;
+
+   // Expands the trip chains and computes the cost of the new column.
+   auto prepareColumn() noexcept -> void;
 };
@@ -1,10 +1,44 @@
 #include "CgMasterClp.h"
 #include "Instance.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <vector>
 
 using namespace std;
 
+// State shared by the solvers of a race, which may outlive it when the barrier loses.
+struct CgMasterClp::RaceState {
+   mutex mtx;
+   condition_variable cv;
+   atomic<int> winner{-1};
+   int numFinished{0};
+   bool barrierDone{false};
+};
+
+namespace {
+// Stops a simplex solve at the end of an iteration, once the race has a winner.
+class RaceEventHandler: public ClpEventHandler {
+public:
+   RaceEventHandler(const atomic<int> &winner): m_winner(&winner) {
+   }
+
+   virtual int event(Event whichEvent) override {
+      if (whichEvent == endOfIteration && m_winner->load() != -1)
+         return 0;
+      return -1;
+   }
+
+   virtual ClpEventHandler *clone() const override {
+      return new RaceEventHandler(*this);
+   }
+
+private:
+   const atomic<int> *m_winner;
+};
+}
+
 CgMasterClp::CgMasterClp(const Instance &inst): CgMasterBase(inst) {
    // This implementation does not uses CoinModel because the RMP is really
    // simple to build, and has a very minimal size so the time spent resizing
@@ -50,8 +84,13 @@ CgMasterClp::CgMasterClp(const Instance &inst): CgMasterBase(inst) {
    m_lpSolver->initialSolve();
 }
 
+CgMasterClp::CgMasterClp(const CgMasterClp &other): CgMasterBase(other) {
+   m_lpSolver.reset(new OsiClpSolverInterface(*other.m_lpSolver));
+}
+
 CgMasterClp::~CgMasterClp() {
-   // Empty, probably
+   if (m_barrierThread.joinable())
+      m_barrierThread.join();
 }
 
 auto CgMasterClp::getSolverName() const noexcept -> std::string {
@@ -62,6 +101,10 @@ auto CgMasterClp::writeLp(const char *fname) const noexcept -> void {
    m_lpSolver->writeLp(fname, "");
 }
 
+auto CgMasterClp::clone() const noexcept -> std::unique_ptr<CgMasterBase> {
+   return unique_ptr<CgMasterBase>(new CgMasterClp(*this));
+}
+
 auto CgMasterClp::solve(const char algo) noexcept -> double {
    switch(algo) {
       case 'p':
@@ -72,14 +115,46 @@ auto CgMasterClp::solve(const char algo) noexcept -> double {
       case 'D':
          m_lpSolver->getModelPtr()->dual(2);
          break;
+      case 'r':
+      case 'R':
+         race();
+         break;
+      case 'b':
+      case 'B':
+         // The resolve would take the solution back to a vertex.
+         m_lpSolver->getModelPtr()->barrier(false);
+         m_numIterations += m_lpSolver->getModelPtr()->numberIterations();
+         return m_lpSolver->getObjValue();
       default:
          cout << "Unknown algorithm '" << algo << "'" << endl;
          abort();
    }
+   m_numIterations += m_lpSolver->getModelPtr()->numberIterations();
    m_lpSolver->resolve();
+   m_numIterations += m_lpSolver->getIterationCount();
    return m_lpSolver->getObjValue();
 }
 
+auto CgMasterClp::setObjLimit(double limit) noexcept -> void {
+   m_lpSolver->setDblParam(OsiDualObjectiveLimit, min(limit, COIN_DBL_MAX));
+}
+
+auto CgMasterClp::getBasis() const noexcept -> Basis {
+   Basis basis;
+   basis.rowStatus.resize(m_lpSolver->getNumRows());
+   basis.colStatus.resize(m_lpSolver->getNumCols());
+   m_lpSolver->getBasisStatus(basis.colStatus.data(), basis.rowStatus.data());
+   return basis;
+}
+
+auto CgMasterClp::setBasis(const Basis &basis) noexcept -> void {
+   assert((int) basis.rowStatus.size() == m_lpSolver->getNumRows());
+   // Status 3 means non-basic at the lower bound.
+   vector<int> colStatus(basis.colStatus);
+   colStatus.resize(m_lpSolver->getNumCols(), 3);
+   m_lpSolver->setBasisStatus(colStatus.data(), basis.rowStatus.data());
+}
+
 auto CgMasterClp::getObjValue() const noexcept -> double {
    return m_lpSolver->getObjValue();
 }
@@ -99,29 +174,112 @@ auto CgMasterClp::setAssignmentType(char sense) noexcept -> void {
    }
 }
 
+// Path columns are stored after the dummy columns (one per trip.)
 auto CgMasterClp::getValue(int col) const noexcept -> double {
-   return m_lpSolver->getColSolution()[col];
+   return m_lpSolver->getColSolution()[col + m_inst->numTrips()];
 }
 
 auto CgMasterClp::getLb(int col) const noexcept -> double {
-   return m_lpSolver->getColLower()[col];
+   return m_lpSolver->getColLower()[col + m_inst->numTrips()];
 }
 
 auto CgMasterClp::setLb(int col, double bound) noexcept -> void {
    //m_lpSolver->setObjCoeff(col, 0.0);
-   m_lpSolver->setColLower(col, bound);
+   m_lpSolver->setColLower(col + m_inst->numTrips(), bound);
 }
 
 auto CgMasterClp::convertToBinary() noexcept -> void {
    for (int col = 0; col < numColumns(); ++col) {
-      m_lpSolver->setInteger(col);
+      m_lpSolver->setInteger(col + m_inst->numTrips());
    }
 }
 
 auto CgMasterClp::convertToRelaxed() noexcept -> void {
    for (int col = 0; col < numColumns(); ++col) {
-      m_lpSolver->setContinuous(col);
+      m_lpSolver->setContinuous(col + m_inst->numTrips());
+   }
+}
+
+auto CgMasterClp::raceWinner() const noexcept -> char {
+   return m_raceWinner;
+}
+
+auto CgMasterClp::numIterations() const noexcept -> long {
+   return m_numIterations;
+}
+
+auto CgMasterClp::race() noexcept -> void {
+   static const char algos[] = {'p', 'd', 'b'};
+
+   // Collects the barrier of a previous race, if it has finished.
+   bool barrierBusy = false;
+   if (m_barrierThread.joinable()) {
+      {
+         lock_guard<mutex> lock(m_barrierRace->mtx);
+         barrierBusy = !m_barrierRace->barrierDone;
+      }
+      if (!barrierBusy) {
+         m_barrierThread.join();
+         m_barrierSolver.reset();
+         m_barrierRace.reset();
+      }
+   }
+
+   auto state = make_shared<RaceState>();
+   RaceEventHandler handler(state->winner);
+   const int numRacers = barrierBusy ? 2 : 3;
+   vector<unique_ptr<OsiClpSolverInterface>> solvers(2);
+   vector<thread> threads;
+   for (int r = 0; r < numRacers; ++r) {
+      unique_ptr<OsiClpSolverInterface> solver(new OsiClpSolverInterface(*m_lpSolver));
+      solver->getModelPtr()->passInEventHandler(&handler);
+      auto run = [state, model = solver->getModelPtr(), r]() {
+         switch (algos[r]) {
+            case 'p': model->primal(2); break;
+            case 'd': model->dual(2); break;
+            case 'b': model->barrier(true); break;
+         }
+         lock_guard<mutex> lock(state->mtx);
+         if (model->isProvenOptimal()) {
+            int none = -1;
+            state->winner.compare_exchange_strong(none, r);
+         }
+         ++state->numFinished;
+         state->barrierDone = state->barrierDone || algos[r] == 'b';
+         state->cv.notify_all();
+      };
+      if (algos[r] == 'b') {
+         m_barrierSolver = move(solver);
+         m_barrierRace = state;
+         m_barrierThread = thread(run);
+      } else {
+         solvers[r] = move(solver);
+         threads.emplace_back(run);
+      }
+   }
+
+   int winner;
+   {
+      unique_lock<mutex> lock(state->mtx);
+      state->cv.wait(lock, [&] { return state->winner != -1 || state->numFinished == numRacers; });
+      // When no solver proves optimality, keeps the primal simplex.
+      winner = state->winner != -1 ? state->winner.load() : 0;
+      state->winner = winner;
    }
+   // The simplex solvers that lost stop at the end of their current iteration.
+   for (auto &t: threads)
+      t.join();
+
+   if (algos[winner] == 'b') {
+      m_barrierThread.join();
+      m_lpSolver = move(m_barrierSolver);
+      m_barrierRace.reset();
+   } else {
+      m_lpSolver = move(solvers[winner]);
+   }
+   ClpEventHandler plainHandler;
+   m_lpSolver->getModelPtr()->passInEventHandler(&plainHandler);
+   m_raceWinner = algos[winner];
 }
 
 auto CgMasterClp::addColumn() noexcept -> void {
@@ -144,3 +302,33 @@ auto CgMasterClp::addColumn() noexcept -> void {
    snprintf(buf, sizeof buf, "path#%d#%d", m_newcolDepot, numColumns());
    m_lpSolver->addCol(rows.size(), rows.data(), coeffs.data(), 0.0, COIN_DBL_MAX, m_newcolCost, buf);
 }
+
+auto CgMasterClp::addColumnsBulk(int first) noexcept -> void {
+   const int nc = m_colDepot.size() - first;
+   if (nc <= 0)
+      return;
+
+   // Assembles the columns in compressed sparse column format, and adds them 
+   // with a single call.
+   vector<int> starts{0}, rows;
+   vector<double> coeffs, lb(nc, 0.0), ub(nc, COIN_DBL_MAX), obj(nc);
+   for (int c = first; c < first + nc; ++c) {
+      for (auto i: m_colTrips[c]) {
+         rows.push_back(i);
+         coeffs.push_back(1.0);
+      }
+      rows.push_back(m_colDepot[c]+m_inst->numTrips());
+      coeffs.push_back(1.0);
+      starts.push_back(rows.size());
+      obj[c - first] = m_colCost[c];
+   }
+
+   const int firstCol = m_lpSolver->getNumCols();
+   m_lpSolver->addCols(nc, starts.data(), rows.data(), coeffs.data(), lb.data(), ub.data(), obj.data());
+
+   char buf[128];
+   for (int c = 0; c < nc; ++c) {
+      snprintf(buf, sizeof buf, "path#%d#%d", m_colDepot[first + c], first + c);
+      m_lpSolver->setColName(firstCol + c, buf);
+   }
+}
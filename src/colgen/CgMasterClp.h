@@ -3,6 +3,7 @@
 #include "CgMasterBase.h"
 #include <coin/OsiClpSolverInterface.hpp>
 #include <memory>
+#include <thread>
 
 class instance;
 
@@ -13,8 +14,17 @@ public:
 
    virtual auto getSolverName() const noexcept -> std::string override;
    virtual auto writeLp(const char *fname) const noexcept -> void override;
+   virtual auto clone() const noexcept -> std::unique_ptr<CgMasterBase> override;
 
+   // Besides 'p' and 'd', accepts 'r' to race the primal simplex, the dual simplex
+   // and the barrier on copies of the model in parallel threads. The first one to
+   // finish with an optimal solution is kept, and the others are stopped. 'b' runs
+   // the barrier without crossover, for duals well inside the optimal face instead
+   // of a vertex. It leaves no optimal basis behind.
    virtual auto solve(const char algo) noexcept -> double override;
+   virtual auto setObjLimit(double limit) noexcept -> void override;
+   virtual auto getBasis() const noexcept -> Basis override;
+   virtual auto setBasis(const Basis &basis) noexcept -> void override;
    virtual auto getObjValue() const noexcept -> double override;
    virtual auto getTripDual(int i) const noexcept -> double override;
    virtual auto getDepotCapDual(int k) const noexcept -> double override;
@@ -28,8 +38,29 @@ public:
    virtual auto convertToBinary() noexcept -> void override;
    virtual auto convertToRelaxed() noexcept -> void override;
 
+   // Algorithm that won the last race: 'p' (primal), 'd' (dual) or 'b' (barrier).
+   auto raceWinner() const noexcept -> char;
+
+   // Number of simplex iterations performed so far, including the barrier ones.
+   auto numIterations() const noexcept -> long;
+
 private:
+   struct RaceState;
+
+   CgMasterClp(const CgMasterClp &other);
+
    std::unique_ptr<OsiClpSolverInterface> m_lpSolver;
 
+   // The barrier only checks for the end of the race in its crossover, so it may keep
+   // running after losing. It enters the next races once finished.
+   std::unique_ptr<OsiClpSolverInterface> m_barrierSolver;
+   std::shared_ptr<RaceState> m_barrierRace;
+   std::thread m_barrierThread;
+   char m_raceWinner{0};
+   long m_numIterations{0};
+
+   auto race() noexcept -> void;
+
    virtual auto addColumn() noexcept -> void override;
+   virtual auto addColumnsBulk(int first) noexcept -> void override;
 };
@@ -43,8 +43,7 @@ CgMasterCplex::CgMasterCplex(const Instance &inst): CgMasterBase(inst) {
       snprintf(buf, sizeof buf, "dummy#%d", i);
 
       IloNumVar path = IloNumVar(col, 0.0, IloInfinity, IloNumVar::Float, buf);
-      // For now, we do nothing with these artificial vars.
-      (void) path;
+      m_dummy.add(path);
       col.end();
    }
 
@@ -68,6 +67,31 @@ auto CgMasterCplex::writeLp(const char *fname) const noexcept -> void {
    m_cplex.exportModel(fname);
 }
 
+auto CgMasterCplex::clone() const noexcept -> std::unique_ptr<CgMasterBase> {
+   // Concert models are bound to their environment, so the copy is rebuilt 
+   // in a new one from the cached columns.
+   auto copy = make_unique<CgMasterCplex>(*m_inst);
+   copy->setTripChains(m_chains);
+
+   vector<int> start{0}, trips;
+   for (const auto &path: m_colTrips) {
+      trips.insert(trips.end(), path.begin(), path.end());
+      start.push_back(trips.size());
+   }
+   copy->addColumns(m_colDepot.size(), m_colDepot.data(), start.data(), trips.data());
+
+   for (int col = 0; col < numColumns(); ++col) {
+      if (const auto lb = getLb(col); lb != 0.0)
+         copy->setLb(col, lb);
+   }
+   if (m_inst->numTrips() > 0 && m_range[0].getUB() < IloInfinity)
+      copy->setAssignmentType('E');
+   copy->setObjLimit(m_objLimit);
+   copy->setBarrierGap(m_barrierGap);
+
+   return copy;
+}
+
 auto CgMasterCplex::solve(const char algo) noexcept -> double {
    switch(algo) {
       case 'p':
@@ -78,11 +102,19 @@ auto CgMasterCplex::solve(const char algo) noexcept -> double {
       case 'D':
          m_cplex.setParam(IloCplex::RootAlg, IloCplex::Dual);
          break;
+      case 'b':
+      case 'B':
+         m_cplex.setParam(IloCplex::RootAlg, IloCplex::Barrier);
+         m_cplex.setParam(IloCplex::BarCrossAlg, CPX_ALG_NONE);
+         m_cplex.setParam(IloCplex::BarEpComp, m_barrierGap);
+         break;
       default:
          cout << "Unknown algorithm '" << algo << "'" << endl;
          abort();
    }
    if (!m_cplex.solve()) {
+      if (m_cplex.getCplexStatus() == IloCplex::AbortObjLim)
+         return m_objLimit;
       cout << "RMP became infeasible.\n";
       writeLp("rmp_problematic.lp");
       abort();
@@ -91,6 +123,56 @@ auto CgMasterCplex::solve(const char algo) noexcept -> double {
    return m_cplex.getObjValue();
 }
 
+auto CgMasterCplex::setObjLimit(double limit) noexcept -> void {
+   m_objLimit = limit;
+   m_cplex.setParam(IloCplex::Param::Simplex::Limits::UpperObj, min(limit, 1e75));
+}
+
+auto CgMasterCplex::getBasis() const noexcept -> Basis {
+   IloNumVarArray vars(m_env);
+   vars.add(m_dummy);
+   vars.add(m_paths);
+   IloConstraintArray cons(m_env);
+   for (IloInt i = 0; i < m_range.getSize(); ++i)
+      cons.add(m_range[i]);
+
+   IloCplex::BasisStatusArray colStatus(m_env), rowStatus(m_env);
+   m_cplex.getBasisStatuses(colStatus, vars, rowStatus, cons);
+
+   Basis basis;
+   for (IloInt i = 0; i < rowStatus.getSize(); ++i)
+      basis.rowStatus.push_back(rowStatus[i]);
+   for (IloInt j = 0; j < colStatus.getSize(); ++j)
+      basis.colStatus.push_back(colStatus[j]);
+
+   colStatus.end();
+   rowStatus.end();
+   cons.end();
+   vars.end();
+   return basis;
+}
+
+auto CgMasterCplex::setBasis(const Basis &basis) noexcept -> void {
+   IloNumVarArray vars(m_env);
+   vars.add(m_dummy);
+   vars.add(m_paths);
+   IloConstraintArray cons(m_env);
+   for (IloInt i = 0; i < m_range.getSize(); ++i)
+      cons.add(m_range[i]);
+
+   IloCplex::BasisStatusArray colStatus(m_env), rowStatus(m_env);
+   for (int status: basis.rowStatus)
+      rowStatus.add(IloCplex::BasisStatus(status));
+   for (IloInt j = 0; j < vars.getSize(); ++j)
+      colStatus.add(j < (IloInt) basis.colStatus.size() ? IloCplex::BasisStatus(basis.colStatus[j]) : IloCplex::AtLower);
+   m_cplex.setBasisStatuses(colStatus, vars, rowStatus, cons);
+
+   colStatus.end();
+   rowStatus.end();
+   cons.end();
+   vars.end();
+}
+
 auto CgMasterCplex::getObjValue() const noexcept -> double {
    return m_cplex.getObjValue();
 }
@@ -122,7 +204,7 @@ auto CgMasterCplex::getLb(int col) const noexcept -> double {
 }
 
 auto CgMasterCplex::setLb(int col, double bound) noexcept -> void {
-   m_paths[col].setLb(bound);
+   m_paths[col].setLB(bound);
 }
 
 auto CgMasterCplex::convertToBinary() noexcept -> void {
@@ -137,6 +219,10 @@ auto CgMasterCplex::convertToRelaxed() noexcept -> void {
    m_binaryConversion.end();
 }
 
+auto CgMasterCplex::setBarrierGap(double gap) noexcept -> void {
+   m_barrierGap = gap;
+}
+
 auto CgMasterCplex::addColumn() noexcept -> void {
    assert(m_newcolDepot != -1);
    assert(!m_newcolPath.empty());
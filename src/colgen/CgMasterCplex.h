@@ -12,8 +12,15 @@ public:
 
    virtual auto getSolverName() const noexcept -> std::string override;
    virtual auto writeLp(const char *fname) const noexcept -> void override;
+   virtual auto clone() const noexcept -> std::unique_ptr<CgMasterBase> override;
 
+   // Besides 'p' and 'd', accepts 'b' to run the barrier without crossover, stopped
+   // at the relative gap of setBarrierGap(), for duals well inside the optimal face
+   // instead of a vertex. It leaves no optimal basis behind.
    virtual auto solve(const char algo) noexcept -> double override;
+   virtual auto setObjLimit(double limit) noexcept -> void override;
+   virtual auto getBasis() const noexcept -> Basis override;
+   virtual auto setBasis(const Basis &basis) noexcept -> void override;
    virtual auto getObjValue() const noexcept -> double override;
    virtual auto getTripDual(int i) const noexcept -> double override;
    virtual auto getDepotCapDual(int k) const noexcept -> double override;
@@ -27,6 +34,8 @@ public:
    virtual auto convertToBinary() noexcept -> void override;
    virtual auto convertToRelaxed() noexcept -> void override;
 
+   auto setBarrierGap(double gap) noexcept -> void;
+
 private:
    IloEnv m_env;
    IloModel m_model;
@@ -40,6 +49,8 @@ private:
    IloNumArray m_duals;
 
    IloConversion m_binaryConversion;
+   double m_objLimit{IloInfinity};
+   double m_barrierGap{1e-8};
 
    virtual auto addColumn() noexcept -> void override;
 };
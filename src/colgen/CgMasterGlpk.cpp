@@ -1,6 +1,7 @@
 #include "CgMasterGlpk.h"
 
 #include <iostream>
+#include <limits>
 #include <vector>
 
 using namespace std;
@@ -9,6 +10,7 @@ CgMasterGlpk::CgMasterGlpk(const Instance &inst): CgMasterBase(inst) {
    // Initializes the basics of GLPK.
    glp_term_out(GLP_OFF);
    m_model = glp_create_prob();
+   m_objLimit = numeric_limits<double>::max();
    char buf[128];
 
    // Basic model data.
@@ -47,6 +49,12 @@ CgMasterGlpk::CgMasterGlpk(const Instance &inst): CgMasterBase(inst) {
    }
 }
 
+CgMasterGlpk::CgMasterGlpk(const CgMasterGlpk &other): CgMasterBase(other) {
+   m_model = glp_create_prob();
+   glp_copy_prob(m_model, other.m_model, GLP_ON);
+   m_objLimit = other.m_objLimit;
+}
+
 CgMasterGlpk::~CgMasterGlpk() {
    glp_delete_prob(m_model);
 }
@@ -59,6 +67,10 @@ auto CgMasterGlpk::writeLp(const char *fname) const noexcept -> void {
    glp_write_lp(m_model, nullptr, fname);
 }
 
+auto CgMasterGlpk::clone() const noexcept -> std::unique_ptr<CgMasterBase> {
+   return unique_ptr<CgMasterBase>(new CgMasterGlpk(*this));
+}
+
 auto CgMasterGlpk::solve(const char algo) noexcept -> double {
    // In this use case, the best method is the primal simplex,
    // mostly because the RMP is always feasible and only requires
@@ -81,12 +93,37 @@ auto CgMasterGlpk::solve(const char algo) noexcept -> double {
    }
 
    parm.presolve = GLP_OFF;
+   parm.obj_ul = m_objLimit;
    
    // Function that calls simplex/dual simplex, according the parameters.
    glp_simplex(m_model, &parm);
    return glp_get_obj_val(m_model);
 }
 
+auto CgMasterGlpk::setObjLimit(double limit) noexcept -> void {
+   m_objLimit = min(limit, numeric_limits<double>::max());
+}
+
+auto CgMasterGlpk::getBasis() const noexcept -> Basis {
+   Basis basis;
+   basis.rowStatus.resize(glp_get_num_rows(m_model));
+   basis.colStatus.resize(glp_get_num_cols(m_model));
+   for (size_t i = 0; i < basis.rowStatus.size(); ++i)
+      basis.rowStatus[i] = glp_get_row_stat(m_model, i+1);
+   for (size_t j = 0; j < basis.colStatus.size(); ++j)
+      basis.colStatus[j] = glp_get_col_stat(m_model, j+1);
+   return basis;
+}
+
+auto CgMasterGlpk::setBasis(const Basis &basis) noexcept -> void {
+   assert((int) basis.rowStatus.size() == glp_get_num_rows(m_model));
+   for (size_t i = 0; i < basis.rowStatus.size(); ++i)
+      glp_set_row_stat(m_model, i+1, basis.rowStatus[i]);
+   const int numCols = glp_get_num_cols(m_model);
+   for (int j = 0; j < numCols; ++j)
+      glp_set_col_stat(m_model, j+1, j < (int) basis.colStatus.size() ? basis.colStatus[j] : GLP_NL);
+}
+
 auto CgMasterGlpk::getObjValue() const noexcept -> double {
    return glp_get_obj_val(m_model);
 }
@@ -108,28 +145,30 @@ auto CgMasterGlpk::setAssignmentType(char sense) noexcept -> void {
    }
 }
 
+// Path columns are stored after the dummy columns (one per trip.)
 auto CgMasterGlpk::getValue(int col) const noexcept -> double {
-   return glp_get_col_prim(m_model, col+1);
+   return glp_get_col_prim(m_model, col + m_inst->numTrips() + 1);
 }
 
 auto CgMasterGlpk::getLb(int col) const noexcept -> double {
-   return glp_get_col_lb(m_model, col+1);
+   return glp_get_col_lb(m_model, col + m_inst->numTrips() + 1);
 }
 
 auto CgMasterGlpk::setLb(int col, double bound) noexcept -> void {
-   double ub = glp_get_col_ub(m_model, col+1);
-   glp_set_col_bnds(m_model, col+1, GLP_DB, bound, ub);
+   const int colId = col + m_inst->numTrips() + 1;
+   double ub = glp_get_col_ub(m_model, colId);
+   glp_set_col_bnds(m_model, colId, GLP_DB, bound, ub);
 }
 
 auto CgMasterGlpk::convertToBinary() noexcept -> void {
-   for (int col = 1; col <= numColumns(); ++col) {
-      glp_set_col_kind(m_model, col, GLP_BV);
+   for (int col = 0; col < numColumns(); ++col) {
+      glp_set_col_kind(m_model, col + m_inst->numTrips() + 1, GLP_BV);
    }
 }
 
 auto CgMasterGlpk::convertToRelaxed() noexcept -> void {
-   for (int col = 1; col <= numColumns(); ++col) {
-      glp_set_col_kind(m_model, col, GLP_CV);
+   for (int col = 0; col < numColumns(); ++col) {
+      glp_set_col_kind(m_model, col + m_inst->numTrips() + 1, GLP_CV);
    }
 }
 
@@ -159,3 +198,32 @@ auto CgMasterGlpk::addColumn() noexcept -> void {
 
    glp_set_mat_col(m_model, colId, rows.size() - 1, rows.data(), coefs.data());
 }
+
+auto CgMasterGlpk::addColumnsBulk(int first) noexcept -> void {
+   const int nc = m_colDepot.size() - first;
+   if (nc <= 0)
+      return;
+
+   char buf[128];
+   vector<int> rows;
+   vector<double> coefs;
+   int colId = glp_add_cols(m_model, nc);
+   for (int c = first; c < first + nc; ++c, ++colId) {
+      snprintf(buf, sizeof buf, "path#%d#%d", m_colDepot[c], c);
+
+      rows.assign(1, 0);
+      coefs.assign(1, 0.0);
+      rows.push_back(m_colDepot[c] + m_inst->numTrips() + 1);
+      coefs.push_back(1.0);
+      for (int i: m_colTrips[c]) {
+         rows.push_back(i+1);
+         coefs.push_back(1.0);
+      }
+
+      glp_set_col_name(m_model, colId, buf);
+      glp_set_col_kind(m_model, colId, GLP_CV);
+      glp_set_col_bnds(m_model, colId, GLP_LO, 0.0, 0.0);
+      glp_set_obj_coef(m_model, colId, m_colCost[c]);
+      glp_set_mat_col(m_model, colId, rows.size() - 1, rows.data(), coefs.data());
+   }
+}
@@ -12,8 +12,12 @@ public:
 
    virtual auto getSolverName() const noexcept -> std::string override;
    virtual auto writeLp(const char *fname) const noexcept -> void override;
+   virtual auto clone() const noexcept -> std::unique_ptr<CgMasterBase> override;
 
    virtual auto solve(const char algo) noexcept -> double override;
+   virtual auto setObjLimit(double limit) noexcept -> void override;
+   virtual auto getBasis() const noexcept -> Basis override;
+   virtual auto setBasis(const Basis &basis) noexcept -> void override;
    virtual auto getObjValue() const noexcept -> double override;
    virtual auto getTripDual(int i) const noexcept -> double override;
    virtual auto getDepotCapDual(int k) const noexcept -> double override;
@@ -28,7 +32,11 @@ public:
    virtual auto convertToRelaxed() noexcept -> void override;
 
 private:
+   CgMasterGlpk(const CgMasterGlpk &other);
+
    glp_prob *m_model;
+   double m_objLimit;
 
    virtual auto addColumn() noexcept -> void override;
+   virtual auto addColumnsBulk(int first) noexcept -> void override;
 };
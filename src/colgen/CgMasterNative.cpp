@@ -0,0 +1,839 @@
+#include "CgMasterNative.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <random>
+
+using namespace std;
+
+namespace {
+   constexpr double Infinity = numeric_limits<double>::infinity();
+   constexpr double DummyCost = 1e7;
+
+   // Primal and dual feasibility tolerances, and smallest acceptable pivot.
+   constexpr double PrimalTol = 1e-7;
+   constexpr double DualTol = 1e-7;
+   constexpr double PivotTol = 1e-9;
+
+   // The duals reach the cost of the dummy columns, and their rounding errors grow with
+   // them. The tolerance of the reduced costs in the primal simplex grows accordingly.
+   constexpr double RelDualTol = 1e-6;
+
+   // Number of basis updates between refactorizations.
+   constexpr int RefactorInterval = 100;
+
+   // Consecutive degenerate pivots after which the bounds are perturbed, and then
+   // Bland's rule is used, to avoid stalling.
+   constexpr int MaxDegeneratePivots = 50;
+   constexpr double Perturbation = 1e-6;
+
+   // Restarts of the simplex after numerical trouble.
+   constexpr int MaxAttempts = 5;
+
+   // Dual simplex status.
+   enum { DualFeasible, DualInfeasible, DualObjLimit };
+}
+
+CgMasterNative::CgMasterNative(const Instance &inst): CgMasterBase(inst) {
+   const int N = m_inst->numTrips();
+   const int K = m_inst->numDepots();
+   m_numRows = N + K;
+   m_objLimit = Infinity;
+
+   // Logicals, then the dummy columns. All of them start at zero.
+   m_lb.assign(m_numRows + N, 0.0);
+   m_ub.assign(m_numRows + N, Infinity);
+   m_costShift.assign(m_numRows + N, 0.0);
+
+   // The starting basis is made of the dummy columns and the depot slacks, which is
+   // feasible for both types of assignment constraint.
+   m_pos.assign(m_numRows + N, -1);
+   for (int i = 0; i < N; ++i)
+      m_pos[m_numRows + i] = i;
+   for (int k = 0; k < K; ++k)
+      m_pos[N + k] = N + k;
+}
+
+CgMasterNative::~CgMasterNative() {
+   // Empty
+}
+
+auto CgMasterNative::getSolverName() const noexcept -> std::string {
+   return "Native revised simplex";
+}
+
+auto CgMasterNative::writeLp(const char *fname) const noexcept -> void {
+   const int N = m_inst->numTrips();
+
+   vector<string> names(numVars());
+   char buf[128];
+   for (int i = 0; i < N; ++i) {
+      snprintf(buf, sizeof buf, "dummy#%d", i);
+      names[m_numRows + i] = buf;
+   }
+   for (int c = 0; c < numColumns(); ++c) {
+      snprintf(buf, sizeof buf, "path#%d#%d", m_colDepot[c], c);
+      names[m_numRows + N + c] = buf;
+   }
+
+   // Columns of each row.
+   vector<vector<int>> rows(m_numRows);
+   for (int i = 0; i < N; ++i)
+      rows[i].push_back(m_numRows + i);
+   for (int c = 0; c < numColumns(); ++c) {
+      for (int i: m_colTrips[c])
+         rows[i].push_back(m_numRows + N + c);
+      rows[N + m_colDepot[c]].push_back(m_numRows + N + c);
+   }
+
+   ofstream out(fname);
+   out.precision(15);
+   out << "\\Problem name: mdvsp_master_native\n\nMinimize\n obj:";
+   for (int var = m_numRows; var < numVars(); ++var) {
+      out << " + " << (var < m_numRows + N ? DummyCost : m_colCost[var - m_numRows - N]) << " " << names[var];
+      if ((var - m_numRows) % 8 == 7)
+         out << "\n";
+   }
+
+   out << "\n\nSubject To\n";
+   for (int r = 0; r < m_numRows; ++r) {
+      if (r < N)
+         snprintf(buf, sizeof buf, "task_assign#%d", r);
+      else
+         snprintf(buf, sizeof buf, "depot_cap#%d", r - N);
+      out << " " << buf << ":";
+      if (rows[r].empty())
+         out << " 0 " << names[m_numRows];
+      for (size_t t = 0; t < rows[r].size(); ++t) {
+         out << " + " << names[rows[r][t]];
+         if (t % 8 == 7)
+            out << "\n";
+      }
+      if (r < N)
+         out << (m_ub[r] == 0.0 ? " = 1\n" : " >= 1\n");
+      else
+         out << " <= " << m_inst->depotCapacity(r - N) << "\n";
+   }
+
+   out << "\nBounds\n";
+   for (int var = m_numRows + N; var < numVars(); ++var) {
+      if (m_lb[var] != 0.0)
+         out << " " << names[var] << " >= " << m_lb[var] << "\n";
+   }
+
+   if (m_binary) {
+      out << "\nBinaries\n";
+      for (int var = m_numRows + N; var < numVars(); ++var)
+         out << " " << names[var] << "\n";
+   }
+   out << "\nEnd\n";
+}
+
+auto CgMasterNative::clone() const noexcept -> std::unique_ptr<CgMasterBase> {
+   return unique_ptr<CgMasterBase>(new CgMasterNative(*this));
+}
+
+auto CgMasterNative::solve(const char) noexcept -> double {
+   if (!m_factorized)
+      factorize();
+   computePrimal();
+
+   // The primal simplex stops when the basis loses its primal feasibility, which
+   // the dual simplex then restores.
+   for (int attempt = 0; attempt < MaxAttempts; ++attempt) {
+      if (!primalFeasible()) {
+         // The dual simplex needs a dual feasible basis, which is obtained by shifting
+         // the costs of the non-basic variables with negative reduced costs.
+         computeDual();
+         for (int var = 0; var < numVars(); ++var) {
+            if (m_pos[var] != -1 || m_lb[var] == m_ub[var])
+               continue;
+            if (const auto rc = cost(var) - dot(var, m_dual); rc < -DualTol) {
+               m_costShift[var] = -rc;
+               m_shifted = true;
+            }
+         }
+
+         // The objective limit only holds for the original costs.
+         const auto status = dualSimplex(!m_shifted && m_objLimit < Infinity);
+         if (m_shifted) {
+            fill(m_costShift.begin(), m_costShift.end(), 0.0);
+            m_shifted = false;
+         }
+         if (status == DualInfeasible) {
+            computeDual();
+            m_objValue = Infinity;
+            return m_objValue;
+         }
+         if (status == DualObjLimit) {
+            computeDual();
+            computeObjValue();
+            return m_objValue;
+         }
+      }
+      if (primalSimplex())
+         break;
+   }
+
+   computeDual();
+   computeObjValue();
+   return m_objValue;
+}
+
+auto CgMasterNative::setObjLimit(double limit) noexcept -> void {
+   m_objLimit = limit;
+}
+
+// Status 1 means basic, and 0 non-basic at the lower bound.
+auto CgMasterNative::getBasis() const noexcept -> Basis {
+   Basis basis;
+   basis.rowStatus.resize(m_numRows);
+   basis.colStatus.resize(numVars() - m_numRows);
+   for (int r = 0; r < m_numRows; ++r)
+      basis.rowStatus[r] = m_pos[r] != -1;
+   for (size_t j = 0; j < basis.colStatus.size(); ++j)
+      basis.colStatus[j] = m_pos[m_numRows + j] != -1;
+   return basis;
+}
+
+auto CgMasterNative::setBasis(const Basis &basis) noexcept -> void {
+   assert((int) basis.rowStatus.size() == m_numRows);
+   for (int r = 0; r < m_numRows; ++r)
+      m_pos[r] = basis.rowStatus[r] ? 0 : -1;
+   for (int j = 0; j < numVars() - m_numRows; ++j)
+      m_pos[m_numRows + j] = j < (int) basis.colStatus.size() && basis.colStatus[j] ? 0 : -1;
+   m_factorized = false;
+}
+
+auto CgMasterNative::getObjValue() const noexcept -> double {
+   return m_objValue;
+}
+
+auto CgMasterNative::getTripDual(int i) const noexcept -> double {
+   assert(i >= 0 && i < m_inst->numTrips());
+   return m_dual.empty() ? 0.0 : m_dual[i];
+}
+
+auto CgMasterNative::getDepotCapDual(int k) const noexcept -> double {
+   assert(k >= 0 && k < m_inst->numDepots());
+   return m_dual.empty() ? 0.0 : m_dual[m_inst->numTrips() + k];
+}
+
+// The surplus of an equality row is fixed at zero.
+auto CgMasterNative::setAssignmentType(char sense) noexcept -> void {
+   const auto ub = sense == 'E' ? 0.0 : Infinity;
+   for (int i = 0; i < m_inst->numTrips(); ++i)
+      m_ub[i] = ub;
+}
+
+// Path columns are stored after the logicals and the dummy columns.
+auto CgMasterNative::getValue(int col) const noexcept -> double {
+   const int var = m_numRows + m_inst->numTrips() + col;
+   return m_pos[var] != -1 && m_factorized ? m_xB[m_pos[var]] : m_lb[var];
+}
+
+auto CgMasterNative::getLb(int col) const noexcept -> double {
+   return m_lb[m_numRows + m_inst->numTrips() + col];
+}
+
+auto CgMasterNative::setLb(int col, double bound) noexcept -> void {
+   m_lb[m_numRows + m_inst->numTrips() + col] = bound;
+}
+
+auto CgMasterNative::convertToBinary() noexcept -> void {
+   m_binary = true;
+}
+
+auto CgMasterNative::convertToRelaxed() noexcept -> void {
+   m_binary = false;
+}
+
+auto CgMasterNative::numIterations() const noexcept -> long {
+   return m_numIterations;
+}
+
+auto CgMasterNative::numVars() const noexcept -> int {
+   return m_lb.size();
+}
+
+auto CgMasterNative::cost(int var) const noexcept -> double {
+   const int N = m_inst->numTrips();
+   double c = 0.0;
+   if (var >= m_numRows + N)
+      c = m_colCost[var - m_numRows - N];
+   else if (var >= m_numRows)
+      c = DummyCost;
+   return m_shifted ? c + m_costShift[var] : c;
+}
+
+// Columns are 0/1, except for the surplus of the trip rows, so the product is a sum.
+auto CgMasterNative::dot(int var, const vector<double> &v) const noexcept -> double {
+   const int N = m_inst->numTrips();
+   if (var < m_numRows)
+      return var < N ? -v[var] : v[var];
+   if (var < m_numRows + N)
+      return v[var - m_numRows];
+   const int col = var - m_numRows - N;
+   double sum = v[N + m_colDepot[col]];
+   for (int i: m_colTrips[col])
+      sum += v[i];
+   return sum;
+}
+
+auto CgMasterNative::scatter(int var, vector<double> &v) const noexcept -> void {
+   const int N = m_inst->numTrips();
+   if (var < m_numRows) {
+      v[var] = var < N ? -1.0 : 1.0;
+   } else if (var < m_numRows + N) {
+      v[var - m_numRows] = 1.0;
+   } else {
+      const int col = var - m_numRows - N;
+      v[N + m_colDepot[col]] = 1.0;
+      for (int i: m_colTrips[col])
+         v[i] = 1.0;
+   }
+}
+
+auto CgMasterNative::rowsOf(int var, vector<int> &rows) const noexcept -> void {
+   const int N = m_inst->numTrips();
+   if (var < m_numRows) {
+      rows.push_back(var);
+   } else if (var < m_numRows + N) {
+      rows.push_back(var - m_numRows);
+   } else {
+      const int col = var - m_numRows - N;
+      rows.insert(rows.end(), m_colTrips[col].begin(), m_colTrips[col].end());
+      rows.push_back(N + m_colDepot[col]);
+   }
+}
+
+auto CgMasterNative::ftran(vector<double> &v) const noexcept -> void {
+   const int numSteps = m_luRow.size();
+   for (int k = 0; k < numSteps; ++k) {
+      if (const double vr = v[m_luRow[k]]; vr != 0.0) {
+         for (int t = m_lStart[k]; t < m_lStart[k + 1]; ++t)
+            v[m_lIndex[t]] -= m_lValue[t] * vr;
+      }
+   }
+   for (int k = numSteps - 1; k >= 0; --k) {
+      double sum = v[m_luRow[k]];
+      for (int t = m_uStart[k]; t < m_uStart[k + 1]; ++t)
+         sum -= m_uValue[t] * v[m_uIndex[t]];
+      v[m_luRow[k]] = sum / m_uPivot[k];
+   }
+
+   for (size_t e = 0; e < m_etaRow.size(); ++e) {
+      const int p = m_etaRow[e];
+      if (v[p] == 0.0)
+         continue;
+      const double vp = v[p] / m_etaPivot[e];
+      v[p] = vp;
+      for (int k = m_etaStart[e]; k < m_etaStart[e + 1]; ++k)
+         v[m_etaIndex[k]] -= m_etaValue[k] * vp;
+   }
+}
+
+auto CgMasterNative::btran(vector<double> &v) const noexcept -> void {
+   for (int e = int(m_etaRow.size()) - 1; e >= 0; --e) {
+      const int p = m_etaRow[e];
+      double sum = v[p];
+      for (int k = m_etaStart[e]; k < m_etaStart[e + 1]; ++k)
+         sum -= m_etaValue[k] * v[m_etaIndex[k]];
+      v[p] = sum / m_etaPivot[e];
+   }
+
+   const int numSteps = m_luRow.size();
+   for (int k = 0; k < numSteps; ++k) {
+      const double z = v[m_luRow[k]] / m_uPivot[k];
+      v[m_luRow[k]] = z;
+      if (z == 0.0)
+         continue;
+      for (int t = m_uStart[k]; t < m_uStart[k + 1]; ++t)
+         v[m_uIndex[t]] -= m_uValue[t] * z;
+   }
+   for (int k = numSteps - 1; k >= 0; --k) {
+      double sum = 0.0;
+      for (int t = m_lStart[k]; t < m_lStart[k + 1]; ++t)
+         sum += m_lValue[t] * v[m_lIndex[t]];
+      v[m_luRow[k]] -= sum;
+   }
+}
+
+auto CgMasterNative::pushEta(int row, const vector<double> &d) noexcept -> void {
+   m_etaRow.push_back(row);
+   m_etaPivot.push_back(d[row]);
+   for (int i = 0; i < m_numRows; ++i) {
+      if (i != row && fabs(d[i]) > 1e-12) {
+         m_etaIndex.push_back(i);
+         m_etaValue.push_back(d[i]);
+      }
+   }
+   m_etaStart.push_back(m_etaIndex.size());
+}
+
+auto CgMasterNative::factorize() noexcept -> void {
+   m_etaRow.clear();
+   m_etaPivot.clear();
+   m_etaStart.assign(1, 0);
+   m_etaIndex.clear();
+   m_etaValue.clear();
+   m_luRow.clear();
+   m_uPivot.clear();
+   m_lStart.assign(1, 0);
+   m_lIndex.clear();
+   m_lValue.clear();
+   m_uStart.assign(1, 0);
+   m_uIndex.clear();
+   m_uValue.clear();
+
+   // Active submatrix, by columns, with the pattern of its rows.
+   vector<int> basic, rows;
+   vector<vector<pair<int, double>>> colEntries;
+   vector<vector<int>> rowCols(m_numRows);
+   vector<int> rowCount(m_numRows, 0);
+   for (int var = 0; var < numVars(); ++var) {
+      if (m_pos[var] == -1)
+         continue;
+      m_pos[var] = -1;
+      rows.clear();
+      rowsOf(var, rows);
+      const double value = var < m_inst->numTrips() ? -1.0 : 1.0;
+      colEntries.emplace_back();
+      for (int r: rows) {
+         colEntries.back().emplace_back(r, value);
+         rowCols[r].push_back(basic.size());
+         ++rowCount[r];
+      }
+      basic.push_back(var);
+   }
+   const int numBasic = basic.size();
+   vector<char> colActive(numBasic, 1);
+   vector<int> colRow(numBasic, -1);
+   m_head.assign(m_numRows, -1);
+
+   auto removeColumn = [&](int c) {
+      colActive[c] = 0;
+      for (const auto &[r, value]: colEntries[c])
+         --rowCount[r];
+   };
+
+   // Gaussian elimination, choosing the pivots by the Markowitz criterion: rows of a
+   // single entry first, otherwise the column with the fewest entries, pivoting on
+   // its row with the fewest entries among the ones large enough for stability.
+   vector<int> where(m_numRows, -1);
+   vector<pair<int, double>> uRow;
+   for (int step = 0; step < numBasic; ++step) {
+      int pr = -1, pc = -1;
+      for (int r = 0; r < m_numRows && pc == -1; ++r) {
+         if (m_head[r] != -1 || rowCount[r] != 1)
+            continue;
+         for (int c: rowCols[r]) {
+            if (!colActive[c])
+               continue;
+            for (const auto &[i, value]: colEntries[c]) {
+               if (i == r && fabs(value) > PivotTol * 1e3) {
+                  pr = r;
+                  pc = c;
+               }
+            }
+         }
+      }
+      while (pc == -1) {
+         int best = -1;
+         for (int c = 0; c < numBasic; ++c) {
+            if (colActive[c] && (best == -1 || colEntries[c].size() < colEntries[best].size()))
+               best = c;
+         }
+         if (best == -1)
+            break;
+         double maxValue = 0.0;
+         for (const auto &[i, value]: colEntries[best])
+            maxValue = max(maxValue, fabs(value));
+         // Dependent columns leave the basis.
+         if (maxValue <= PivotTol * 1e3) {
+            removeColumn(best);
+            continue;
+         }
+         for (const auto &[i, value]: colEntries[best]) {
+            if (fabs(value) >= 0.1 * maxValue && (pr == -1 || rowCount[i] < rowCount[pr]))
+               pr = i;
+         }
+         pc = best;
+      }
+      if (pc == -1)
+         break;
+
+      // Row of U, taken out of the active columns.
+      double pivotValue = 0.0;
+      uRow.clear();
+      for (int c: rowCols[pr]) {
+         if (!colActive[c])
+            continue;
+         auto &entries = colEntries[c];
+         for (size_t t = 0; t < entries.size(); ++t) {
+            if (entries[t].first != pr)
+               continue;
+            if (c == pc)
+               pivotValue = entries[t].second;
+            else
+               uRow.emplace_back(c, entries[t].second);
+            if (c != pc) {
+               entries[t] = entries.back();
+               entries.pop_back();
+            }
+            break;
+         }
+      }
+      removeColumn(pc);
+      m_head[pr] = basic[pc];
+      colRow[pc] = pr;
+
+      // Column of L, and update of the active submatrix.
+      m_luRow.push_back(pr);
+      m_uPivot.push_back(pivotValue);
+      for (const auto &[i, value]: colEntries[pc]) {
+         if (i == pr)
+            continue;
+         const double l = value / pivotValue;
+         m_lIndex.push_back(i);
+         m_lValue.push_back(l);
+      }
+      m_lStart.push_back(m_lIndex.size());
+      for (const auto &[c, u]: uRow) {
+         auto &entries = colEntries[c];
+         for (size_t t = 0; t < entries.size(); ++t)
+            where[entries[t].first] = t;
+         for (int t = m_lStart[step]; t < m_lStart[step + 1]; ++t) {
+            const int i = m_lIndex[t];
+            if (where[i] != -1) {
+               entries[where[i]].second -= m_lValue[t] * u;
+            } else {
+               where[i] = entries.size();
+               entries.emplace_back(i, -m_lValue[t] * u);
+               rowCols[i].push_back(c);
+               ++rowCount[i];
+            }
+         }
+         for (const auto &entry: entries)
+            where[entry.first] = -1;
+         --rowCount[pr];
+         m_uIndex.push_back(c);
+         m_uValue.push_back(u);
+      }
+      m_uStart.push_back(m_uIndex.size());
+   }
+
+   // U refers to the columns, which are stored at the positions of their pivot rows.
+   // Entries of the dependent columns, dropped after their row of U was built, go
+   // away with them.
+   int nnz = 0;
+   for (size_t k = 0; k + 1 < m_uStart.size(); ++k) {
+      const int start = m_uStart[k];
+      m_uStart[k] = nnz;
+      for (int t = start; t < m_uStart[k + 1]; ++t) {
+         if (colRow[m_uIndex[t]] != -1) {
+            m_uIndex[nnz] = colRow[m_uIndex[t]];
+            m_uValue[nnz++] = m_uValue[t];
+         }
+      }
+   }
+   m_uStart.back() = nnz;
+   m_uIndex.resize(nnz);
+   m_uValue.resize(nnz);
+   for (int r = 0; r < m_numRows; ++r) {
+      if (m_head[r] != -1) {
+         m_pos[m_head[r]] = r;
+         continue;
+      }
+      // Completes the basis with the logicals of the rows left without pivot.
+      m_luRow.push_back(r);
+      m_uPivot.push_back(r < m_inst->numTrips() ? -1.0 : 1.0);
+      m_lStart.push_back(m_lIndex.size());
+      m_uStart.push_back(m_uIndex.size());
+      m_head[r] = r;
+      m_pos[r] = r;
+   }
+
+   m_numUpdates = 0;
+   m_factorized = true;
+}
+
+auto CgMasterNative::pivot(int pos, int enter, const vector<double> &d, double step) noexcept -> void {
+   for (int i = 0; i < m_numRows; ++i)
+      m_xB[i] -= step * d[i];
+   m_pos[m_head[pos]] = -1;
+   m_xB[pos] = m_lb[enter] + step;
+   m_head[pos] = enter;
+   m_pos[enter] = pos;
+   pushEta(pos, d);
+   ++m_numIterations;
+
+   if (++m_numUpdates >= RefactorInterval) {
+      factorize();
+      computePrimal();
+   }
+}
+
+auto CgMasterNative::computePrimal() noexcept -> void {
+   const int N = m_inst->numTrips();
+   m_xB.assign(m_numRows, 1.0);
+   for (int k = 0; k < m_inst->numDepots(); ++k)
+      m_xB[N + k] = m_inst->depotCapacity(k);
+
+   // Non-basic variables sit at their lower bounds, which are only non-zero for the
+   // fixed path columns, and while the bounds are perturbed.
+   vector<int> rows;
+   for (int var = 0; var < numVars(); ++var) {
+      if (m_pos[var] != -1 || m_lb[var] == 0.0)
+         continue;
+      rows.clear();
+      rowsOf(var, rows);
+      const double value = var < N ? -m_lb[var] : m_lb[var];
+      for (int r: rows)
+         m_xB[r] -= value;
+   }
+   ftran(m_xB);
+}
+
+auto CgMasterNative::primalFeasible() const noexcept -> bool {
+   for (int pos = 0; pos < m_numRows; ++pos) {
+      const int var = m_head[pos];
+      if (m_xB[pos] < m_lb[var] - PrimalTol || m_xB[pos] > m_ub[var] + PrimalTol)
+         return false;
+   }
+   return true;
+}
+
+auto CgMasterNative::computeDual() noexcept -> void {
+   m_dual.resize(m_numRows);
+   for (int pos = 0; pos < m_numRows; ++pos)
+      m_dual[pos] = cost(m_head[pos]);
+   btran(m_dual);
+}
+
+auto CgMasterNative::computeObjValue() noexcept -> void {
+   m_objValue = 0.0;
+   for (int var = m_numRows; var < numVars(); ++var) {
+      const auto value = m_pos[var] != -1 ? m_xB[m_pos[var]] : m_lb[var];
+      if (value != 0.0)
+         m_objValue += cost(var) * value;
+   }
+}
+
+auto CgMasterNative::primalSimplex() noexcept -> bool {
+   vector<double> d(m_numRows);
+   int degenerate = 0;
+
+   // Lowers the bounds of the basic variables by small random amounts when the pivots
+   // stall, so that the vertex is no longer degenerate.
+   mt19937 rng{0};
+   uniform_real_distribution<double> unif(Perturbation, 2 * Perturbation);
+   vector<pair<int, double>> perturbed;
+   bool wasPerturbed = false;
+   auto restore = [&]() {
+      if (perturbed.empty())
+         return;
+      for (const auto &[var, delta]: perturbed)
+         m_lb[var] += delta;
+      perturbed.clear();
+      computePrimal();
+   };
+
+   while (true) {
+      if (degenerate >= MaxDegeneratePivots && !wasPerturbed) {
+         wasPerturbed = true;
+         for (int pos = 0; pos < m_numRows; ++pos) {
+            perturbed.emplace_back(m_head[pos], unif(rng));
+            m_lb[m_head[pos]] -= perturbed.back().second;
+         }
+         degenerate = 0;
+      }
+      computeDual();
+      const bool bland = degenerate >= MaxDegeneratePivots;
+      double maxDual = 0.0;
+      for (double y: m_dual)
+         maxDual = max(maxDual, fabs(y));
+      const double rcTol = DualTol * max(1.0, RelDualTol * maxDual);
+
+      // Partial pricing: scans the variables from where the last scan stopped, and
+      // takes the best candidate once a block of them has been scanned. Reduced costs
+      // are normalized by the length of the columns. Bland's rule takes the first
+      // candidate instead.
+      const int N = m_inst->numTrips();
+      const int n = numVars();
+      const int block = max(1000, n / 8);
+      const int first = bland ? 0 : m_priceStart;
+      int enter = -1;
+      double best = 0.0, enterRc = 0.0;
+      int scanned = 0;
+      for (; scanned < n && (enter == -1 || (scanned < block && !bland)); ++scanned) {
+         const int var = (first + scanned) % n;
+         if (m_pos[var] != -1 || m_lb[var] == m_ub[var])
+            continue;
+         const double rc = cost(var) - dot(var, m_dual);
+         if (rc >= -rcTol)
+            continue;
+         const double len = var < m_numRows + N ? 1.0 : m_colTrips[var - m_numRows - N].size() + 1.0;
+         if (const double score = rc / sqrt(len); score < best) {
+            best = score;
+            enter = var;
+            enterRc = rc;
+         }
+      }
+      if (!bland)
+         m_priceStart = (m_priceStart + scanned) % n;
+      if (enter == -1) {
+         // Removing the perturbation may leave the basis slightly infeasible.
+         restore();
+         return primalFeasible();
+      }
+
+      fill(d.begin(), d.end(), 0.0);
+      scatter(enter, d);
+      ftran(d);
+
+      // Harris ratio test: finds the largest step with the bounds relaxed by the
+      // tolerance, then the largest pivot among the rows blocking within it. Bland's
+      // rule takes the smallest ratio, breaking ties by the smallest variable.
+      const double slack = bland ? 0.0 : PrimalTol;
+      double maxStep = Infinity;
+      for (int i = 0; i < m_numRows; ++i) {
+         const int var = m_head[i];
+         if (d[i] > PivotTol)
+            maxStep = min(maxStep, (m_xB[i] - m_lb[var] + slack) / d[i]);
+         else if (d[i] < -PivotTol && m_ub[var] < Infinity)
+            maxStep = min(maxStep, (m_xB[i] - m_ub[var] - slack) / d[i]);
+      }
+
+      int leave = -1;
+      double step = 0.0, bestPivot = 0.0;
+      for (int i = 0; i < m_numRows && maxStep < Infinity; ++i) {
+         const int var = m_head[i];
+         double ratio = Infinity;
+         if (d[i] > PivotTol)
+            ratio = (m_xB[i] - m_lb[var]) / d[i];
+         else if (d[i] < -PivotTol && m_ub[var] < Infinity)
+            ratio = (m_xB[i] - m_ub[var]) / d[i];
+         if (bland) {
+            if (ratio <= maxStep + 1e-12 && (leave == -1 || var < m_head[leave])) {
+               leave = i;
+               step = max(0.0, ratio);
+            }
+         } else if (ratio <= maxStep && fabs(d[i]) > bestPivot) {
+            bestPivot = fabs(d[i]);
+            leave = i;
+            step = max(0.0, ratio);
+         }
+      }
+      if (leave == -1) {
+         // The dummy columns bound the objective, so this only comes from numerical
+         // trouble. Starts over from fresh factors.
+         restore();
+         factorize();
+         computePrimal();
+         return false;
+      }
+
+      // Pivots that barely improve the objective count as degenerate as well, since they
+      // may only come from rounding errors.
+      degenerate = -enterRc * step > DualTol ? 0 : degenerate + 1;
+      pivot(leave, enter, d, step);
+
+      // A refactorization may replace dependent columns by logicals, breaking the
+      // primal feasibility.
+      if (m_numUpdates == 0 && !primalFeasible()) {
+         restore();
+         return false;
+      }
+   }
+}
+
+auto CgMasterNative::dualSimplex(bool useLimit) noexcept -> int {
+   vector<double> rho(m_numRows), d(m_numRows), alpha, redCost;
+   while (true) {
+      // Leaves the basic variable with the largest infeasibility.
+      int leave = -1;
+      double worst = PrimalTol;
+      for (int pos = 0; pos < m_numRows; ++pos) {
+         const int var = m_head[pos];
+         const auto infeas = max(m_lb[var] - m_xB[pos], m_xB[pos] - m_ub[var]);
+         if (infeas > worst) {
+            worst = infeas;
+            leave = pos;
+         }
+      }
+      if (leave == -1)
+         return DualFeasible;
+
+      const int leaveVar = m_head[leave];
+      const bool toLower = m_xB[leave] < m_lb[leaveVar];
+
+      computeDual();
+      fill(rho.begin(), rho.end(), 0.0);
+      rho[leave] = 1.0;
+      btran(rho);
+
+      // Harris ratio test on the row of the leaving variable. Below its lower bound,
+      // it rises with the entering variables of negative coefficient in the row.
+      const int n = numVars();
+      alpha.resize(n);
+      redCost.resize(n);
+      double maxStep = Infinity;
+      for (int var = 0; var < n; ++var) {
+         alpha[var] = 0.0;
+         if (m_pos[var] != -1 || m_lb[var] == m_ub[var])
+            continue;
+         const double a = toLower ? -dot(var, rho) : dot(var, rho);
+         if (a <= PivotTol)
+            continue;
+         alpha[var] = a;
+         redCost[var] = max(0.0, cost(var) - dot(var, m_dual));
+         maxStep = min(maxStep, (redCost[var] + DualTol) / a);
+      }
+      if (maxStep == Infinity)
+         return DualInfeasible;
+
+      int enter = -1;
+      double bestPivot = 0.0;
+      for (int var = 0; var < n; ++var) {
+         if (alpha[var] != 0.0 && redCost[var] / alpha[var] <= maxStep && alpha[var] > bestPivot) {
+            bestPivot = alpha[var];
+            enter = var;
+         }
+      }
+
+      if (enter != -1) {
+         fill(d.begin(), d.end(), 0.0);
+         scatter(enter, d);
+         ftran(d);
+      }
+      if (enter == -1 || fabs(d[leave]) <= PivotTol) {
+         // The row and the column of the pivot disagree. Fresh factors are tried once.
+         if (m_numUpdates == 0)
+            return DualInfeasible;
+         factorize();
+         computePrimal();
+         continue;
+      }
+      const double bound = toLower ? m_lb[leaveVar] : m_ub[leaveVar];
+      pivot(leave, enter, d, (m_xB[leave] - bound) / d[leave]);
+
+      if (useLimit) {
+         computeObjValue();
+         if (m_objValue >= m_objLimit)
+            return DualObjLimit;
+      }
+   }
+}
+
+auto CgMasterNative::addColumn() noexcept -> void {
+   assert(m_newcolDepot != -1);
+   assert(!m_newcolPath.empty());
+   m_lb.push_back(0.0);
+   m_ub.push_back(Infinity);
+   m_costShift.push_back(0.0);
+   m_pos.push_back(-1);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Instance.h"
+#include "CgMasterBase.h"
+
+#include <vector>
+
+/**
+ * @brief Master problem solved by an in-house revised simplex.
+ *
+ * The RMP only has 0/1 columns, made of the trips of a path plus its depot row, so
+ * the columns are read straight from the pool of CgMasterBase, and the products of
+ * a column by the duals (or by a row of the basis inverse) are plain sums. The basis
+ * is factorized as LU, choosing the pivots by the Markowitz criterion, and each pivot
+ * appends an eta matrix to the factors until the next refactorization. New columns
+ * enter as non-basic, so they never touch the factorization.
+ *
+ * The primal simplex reoptimizes after new columns are added, perturbing the bounds
+ * of the basic variables when the pivots stall on a degenerate vertex. When the basis is
+ * primal infeasible (after fixing bounds, or converting the trip rows to equalities)
+ * the dual simplex runs first, shifting the costs of the dual infeasible variables
+ * when needed.
+ */
+class CgMasterNative: public CgMasterBase {
+public:
+   CgMasterNative(const Instance &inst);
+   virtual ~CgMasterNative();
+
+   virtual auto getSolverName() const noexcept -> std::string override;
+   virtual auto writeLp(const char *fname) const noexcept -> void override;
+   virtual auto clone() const noexcept -> std::unique_ptr<CgMasterBase> override;
+
+   // The algorithm is chosen from the feasibility of the current basis, so `algo`
+   // is ignored.
+   virtual auto solve(const char algo) noexcept -> double override;
+   virtual auto setObjLimit(double limit) noexcept -> void override;
+   virtual auto getBasis() const noexcept -> Basis override;
+   virtual auto setBasis(const Basis &basis) noexcept -> void override;
+   virtual auto getObjValue() const noexcept -> double override;
+   virtual auto getTripDual(int i) const noexcept -> double override;
+   virtual auto getDepotCapDual(int k) const noexcept -> double override;
+
+   virtual auto setAssignmentType(char sense = 'G') noexcept -> void override;
+
+   virtual auto getValue(int col) const noexcept -> double override;
+   virtual auto getLb(int col) const noexcept -> double override;
+   virtual auto setLb(int col, double bound) noexcept -> void override;
+
+   virtual auto convertToBinary() noexcept -> void override;
+   virtual auto convertToRelaxed() noexcept -> void override;
+
+   // Number of simplex iterations performed so far.
+   auto numIterations() const noexcept -> long;
+
+private:
+   CgMasterNative(const CgMasterNative &other) = default;
+
+   // Variables are the logicals of the rows (surplus of the trip rows, slack of the
+   // depot rows), followed by the dummy columns and the path columns.
+   int m_numRows;
+   std::vector<double> m_lb;
+   std::vector<double> m_ub;
+   std::vector<double> m_costShift;
+   bool m_shifted{false};
+
+   // Basis header: basic variable of each position, and position of each variable
+   // (-1 when non-basic, at its lower bound).
+   std::vector<int> m_head;
+   std::vector<int> m_pos;
+   std::vector<double> m_xB;
+   std::vector<double> m_dual;
+
+   // LU factors of the basis, one step per pivot row m_luRow[k]. L is kept as the
+   // multipliers of each step, and U as its rows, by position of the basic variables.
+   std::vector<int> m_luRow;
+   std::vector<double> m_uPivot;
+   std::vector<int> m_lStart;
+   std::vector<int> m_lIndex;
+   std::vector<double> m_lValue;
+   std::vector<int> m_uStart;
+   std::vector<int> m_uIndex;
+   std::vector<double> m_uValue;
+
+   // Product form update of the factors. Eta e pivots on row m_etaRow[e] with value
+   // m_etaPivot[e], and has the off-pivot entries m_etaStart[e] .. m_etaStart[e+1]-1.
+   std::vector<int> m_etaRow;
+   std::vector<double> m_etaPivot;
+   std::vector<int> m_etaStart;
+   std::vector<int> m_etaIndex;
+   std::vector<double> m_etaValue;
+   int m_numUpdates{0};
+   bool m_factorized{false};
+
+   double m_objLimit;
+   double m_objValue{0.0};
+   bool m_binary{false};
+   long m_numIterations{0};
+   int m_priceStart{0};
+
+   auto numVars() const noexcept -> int;
+   auto cost(int var) const noexcept -> double;
+   auto dot(int var, const std::vector<double> &v) const noexcept -> double;
+   auto scatter(int var, std::vector<double> &v) const noexcept -> void;
+   auto rowsOf(int var, std::vector<int> &rows) const noexcept -> void;
+
+   auto ftran(std::vector<double> &v) const noexcept -> void;
+   auto btran(std::vector<double> &v) const noexcept -> void;
+   auto pushEta(int row, const std::vector<double> &d) noexcept -> void;
+   auto factorize() noexcept -> void;
+   auto pivot(int pos, int enter, const std::vector<double> &d, double step) noexcept -> void;
+
+   auto computePrimal() noexcept -> void;
+   auto computeDual() noexcept -> void;
+   auto computeObjValue() noexcept -> void;
+   auto primalFeasible() const noexcept -> bool;
+
+   // The primal simplex returns false when it stops on numerical trouble, or when the
+   // basis loses its primal feasibility. The dual simplex returns whether it reached
+   // primal feasibility, proved infeasibility, or stopped at the objective limit.
+   auto primalSimplex() noexcept -> bool;
+   auto dualSimplex(bool useLimit) noexcept -> int;
+
+   virtual auto addColumn() noexcept -> void override;
+};
@@ -1,5 +1,6 @@
 #include "CgPricingBase.h"
 #include "CgMasterBase.h"
+#include "TripChains.h"
 
 #include "Instance.h"
 #include <algorithm>
@@ -29,6 +30,151 @@ void CgPricingBase::setMaxLabelExpansionsPerNode(int maxExpansions) {
       m_maxLabelExpansions = maxExpansions;
    }
 }
+
+auto CgPricingBase::maxLabelExpansionsPerNode() const noexcept -> int {
+   return m_maxLabelExpansions;
+}
+
+auto CgPricingBase::inheritFrom(const CgPricingBase &other) noexcept -> void {
+   assert(other.m_depotId == m_depotId);
+   m_succAdj = other.m_succAdj;
+   m_predAdj = other.m_predAdj;
+   m_numArcs = other.m_numArcs;
+   m_chains = other.m_chains;
+   m_maxLabelExpansions = other.m_maxLabelExpansions;
+}
+
+auto CgPricingBase::deadheadSuccAdj(int pred) const noexcept -> const std::vector<std::pair<int, int>> & {
+   if (m_succAdj.empty())
+      return m_inst->deadheadSuccAdj(m_depotId, pred);
+   return m_succAdj[pred];
+}
+
+auto CgPricingBase::deadheadPredAdj(int succ) const noexcept -> const std::vector<std::pair<int, int>> & {
+   if (m_predAdj.empty())
+      return m_inst->deadheadPredAdj(m_depotId, succ);
+   return m_predAdj[succ];
+}
+
+auto CgPricingBase::hasDeadheadArc(int pred, int succ) const noexcept -> bool {
+   if (m_succAdj.empty())
+      return m_inst->hasDeadheadArc(m_depotId, pred, succ);
+   const auto &adj = m_succAdj[pred];
+   return find_if(adj.begin(), adj.end(), [&](const pair<int, int> &p) { return p.first == succ; }) != adj.end();
+}
+
+auto CgPricingBase::numDeadheadArcs() const noexcept -> long {
+   if (m_numArcs == -1) {
+      long count = 0;
+      for (int i = 0; i < m_inst->numTrips(); ++i)
+         count += deadheadSuccAdj(i).size();
+      return count;
+   }
+   return m_numArcs;
+}
+
+auto CgPricingBase::computeReducedCostLabels() noexcept -> double {
+   const auto &order = m_inst->topologicalOrder();
+   const auto inf = numeric_limits<double>::infinity();
+
+   m_fwdLabel.assign(m_inst->numTrips(), inf);
+   m_bwdLabel.assign(m_inst->numTrips(), inf);
+
+   // Forward labels: best reduced cost from the source node up to reach trip i,
+   // still not accounting the dual of trip i.
+   const auto depotDual = m_master->getDepotCapDual(m_depotId);
+   for (int i: order) {
+      if (auto cost = m_inst->sourceCost(m_depotId, i); cost != -1)
+         m_fwdLabel[i] = min(m_fwdLabel[i], cost - depotDual);
+      if (m_fwdLabel[i] == inf)
+         continue;
+      const auto label = m_fwdLabel[i] - m_master->getTripDual(i);
+      for (auto &p: deadheadSuccAdj(i))
+         m_fwdLabel[p.first] = min(m_fwdLabel[p.first], label + p.second);
+   }
+
+   // Backward labels: best reduced cost from trip i (including its dual) up to 
+   // the sink node.
+   m_bestReducedCost = inf;
+   for (auto it = order.rbegin(); it != order.rend(); ++it) {
+      const int i = *it;
+      const auto iDual = m_master->getTripDual(i);
+      if (auto cost = m_inst->sinkCost(m_depotId, i); cost != -1)
+         m_bwdLabel[i] = cost - iDual;
+      for (auto &p: deadheadSuccAdj(i))
+         m_bwdLabel[i] = min(m_bwdLabel[i], p.second - iDual + m_bwdLabel[p.first]);
+      m_bestReducedCost = min(m_bestReducedCost, m_fwdLabel[i] + m_bwdLabel[i]);
+   }
+
+   return m_bestReducedCost;
+}
+
+auto CgPricingBase::fixArcsByReducedCost(double gap) noexcept -> int {
+   assert(!m_fwdLabel.empty() && !m_bwdLabel.empty());
+
+   // Since all costs are integer, arcs whose paths cannot reach a solution 
+   // with value <= incumbent - 1 are useless.
+   const auto threshold = gap - 1.0 + 1e-4 + min(0.0, m_bestReducedCost);
+
+   vector<pair<int, int>> removed;
+   for (int i = 0; i < m_inst->numTrips(); ++i) {
+      const auto label = m_fwdLabel[i] - m_master->getTripDual(i);
+      for (auto &p: deadheadSuccAdj(i)) {
+         if (label + p.second + m_bwdLabel[p.first] > threshold)
+            removed.emplace_back(i, p.first);
+      }
+   }
+
+   return removeDeadheadArcs(removed);
+}
+
+auto CgPricingBase::removeDeadheadArcs(std::vector<std::pair<int, int>> arcs) noexcept -> int {
+   // Only the arcs still in the view are removed, grouped by predecessor.
+   arcs.erase(remove_if(arcs.begin(), arcs.end(), [&](const pair<int, int> &a) { 
+      return !hasDeadheadArc(a.first, a.second); 
+   }), arcs.end());
+   sort(arcs.begin(), arcs.end());
+   arcs.erase(unique(arcs.begin(), arcs.end()), arcs.end());
+   if (arcs.empty())
+      return 0;
+
+   // Copy-on-write of the adjacency lists.
+   if (m_succAdj.empty()) {
+      m_succAdj.resize(m_inst->numTrips());
+      m_predAdj.resize(m_inst->numTrips());
+      for (int i = 0; i < m_inst->numTrips(); ++i) {
+         m_succAdj[i] = m_inst->deadheadSuccAdj(m_depotId, i);
+         m_predAdj[i] = m_inst->deadheadPredAdj(m_depotId, i);
+      }
+   }
+
+   // Successor lists are filtered by marking the removed successors.
+   vector<char> mark(m_inst->numTrips(), 0);
+   for (size_t pos = 0; pos < arcs.size();) {
+      const int i = arcs[pos].first;
+      size_t end = pos;
+      for (; end < arcs.size() && arcs[end].first == i; ++end)
+         mark[arcs[end].second] = 1;
+
+      auto &succ = m_succAdj[i];
+      succ.erase(remove_if(succ.begin(), succ.end(), [&](const pair<int, int> &p) { return mark[p.first]; }), succ.end());
+
+      for (; pos < end; ++pos) {
+         const int j = arcs[pos].second;
+         mark[j] = 0;
+         auto &pred = m_predAdj[j];
+         pred.erase(remove_if(pred.begin(), pred.end(), [&](const pair<int, int> &p) { return p.first == i; }), pred.end());
+      }
+   }
+
+   m_numArcs = 0;
+   for (auto &adj: m_succAdj)
+      m_numArcs += adj.size();
+
+   onArcsRemoved(arcs);
+   return arcs.size();
+}
+
 auto CgPricingBase::numNodes() const noexcept -> int {
    return m_inst->numTrips()+2;
 }
@@ -41,3 +187,33 @@ auto CgPricingBase::sinkNode() const noexcept -> int {
    return numNodes() - 1;
 }
 
+auto CgPricingBase::setTripChains(const TripChains *chains) noexcept -> void {
+   m_chains = chains;
+}
+
+auto CgPricingBase::isNodeActive(int trip) const noexcept -> bool {
+   return !m_chains || m_chains->isHead(trip);
+}
+
+auto CgPricingBase::nodeTail(int trip) const noexcept -> int {
+   return m_chains ? m_chains->tail(trip) : trip;
+}
+
+auto CgPricingBase::nodeCost(int trip) const noexcept -> int {
+   return m_chains ? m_chains->internalCost(trip) : 0;
+}
+
+auto CgPricingBase::nodeDual(int trip) const noexcept -> double {
+   if (!m_chains)
+      return m_master->getTripDual(trip);
+
+   double dual = 0.0;
+   for (int t = trip; t != -1; t = m_chains->next(t))
+      dual += m_master->getTripDual(t);
+   return dual;
+}
+
+auto CgPricingBase::onArcsRemoved(const std::vector<std::pair<int, int>> &arcs) noexcept -> void {
+   (void) arcs;
+}
+
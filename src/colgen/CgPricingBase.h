@@ -5,6 +5,7 @@
 
 class Instance;
 class CgMasterBase;
+class TripChains;
 
 class CgPricingBase {
 public:
@@ -36,6 +37,66 @@ public:
     * a very large value (infinity from the practical perspective)
    */
    void setMaxLabelExpansionsPerNode(int maxExpansions);
+   auto maxLabelExpansionsPerNode() const noexcept -> int;
+
+   /**
+    * View of the deadhead arcs available to this subproblem. 
+    * 
+    * Initially, the view matches the adjacency lists of the instance for this depot. Once some arc is
+    * removed by reduced-cost fixing, the subproblem keeps its own copy of the lists.
+    */
+   auto deadheadSuccAdj(int pred) const noexcept -> const std::vector<std::pair<int, int>> &;
+   auto deadheadPredAdj(int succ) const noexcept -> const std::vector<std::pair<int, int>> &;
+   auto hasDeadheadArc(int pred, int succ) const noexcept -> bool;
+   auto numDeadheadArcs() const noexcept -> long;
+
+   /**
+    * Computes forward and backward shortest path labels over the current dual solution.
+    * 
+    * The labels are computed over the full view of the deadhead arcs (disregarding the
+    * limit of label expansions), so the returned value is the exact minimum reduced cost
+    * of a path of this depot.
+    * 
+    * @returns minimum reduced cost of a path starting and ending at this depot.
+    */
+   auto computeReducedCostLabels() noexcept -> double;
+
+   /**
+    * Permanently removes the deadhead arcs that cannot be part of an improving solution.
+    * 
+    * Must be called after `computeReducedCostLabels`. An arc (i,j) is removed when the best
+    * reduced cost of a path traversing it, minus the best reduced cost of the depot, is 
+    * larger than the gap between the incumbent and a valid Lagrangian bound.
+    * 
+    * @param gap difference between the incumbent value and the Lagrangian bound.
+    * @returns number of arcs removed.
+    */
+   auto fixArcsByReducedCost(double gap) noexcept -> int;
+
+   /**
+    * Permanently removes a set of deadhead arcs from the view, e.g., arcs forbidden by branching.
+    * 
+    * @returns number of arcs removed; arcs not in the view are ignored.
+    */
+   auto removeDeadheadArcs(std::vector<std::pair<int, int>> arcs) noexcept -> int;
+
+   /**
+    * Contracts forced trip sequences into single nodes of the pricing graph.
+    * 
+    * Only the label-setting algorithms (SPFA and Bellman-Ford) make use of the 
+    * contraction; the master expands the chains back when receiving columns.
+    * A null pointer disables the contraction.
+    */
+   auto setTripChains(const TripChains *chains) noexcept -> void;
+
+   /**
+    * Copies the view of deadhead arcs, the trip chains, and the limit of label expansions
+    * of `other`, a subproblem of the same depot.
+    * 
+    * Used when creating the subproblems of a cloned master problem. Must be called
+    * before the first call to `solve`.
+    */
+   auto inheritFrom(const CgPricingBase &other) noexcept -> void;
 
 protected:
    const Instance *m_inst;
@@ -48,4 +109,28 @@ protected:
    auto numNodes() const noexcept -> int;
    auto sourceNode() const noexcept -> int;
    auto sinkNode() const noexcept -> int;
+
+   // Nodes of the (possibly contracted) pricing graph. Without contraction,
+   // every trip is an active node with tail in itself, no internal cost, and
+   // the dual of the trip.
+   const TripChains *m_chains{nullptr};
+   auto isNodeActive(int trip) const noexcept -> bool;
+   auto nodeTail(int trip) const noexcept -> int;
+   auto nodeCost(int trip) const noexcept -> int;
+   auto nodeDual(int trip) const noexcept -> double;
+
+   // Notifies the implementation about arcs removed from the view, so that
+   // solver-based subproblems can update their models.
+   virtual auto onArcsRemoved(const std::vector<std::pair<int, int>> &arcs) noexcept -> void;
+
+private:
+   // Own copy of the deadhead adjacency lists (empty until the first removal).
+   std::vector<std::vector<std::pair<int, int>>> m_succAdj;
+   std::vector<std::vector<std::pair<int, int>>> m_predAdj;
+   long m_numArcs{-1};
+
+   // Labels computed by `computeReducedCostLabels`.
+   std::vector<double> m_fwdLabel;
+   std::vector<double> m_bwdLabel;
+   double m_bestReducedCost{0.0};
 };
@@ -0,0 +1,167 @@
+#include "ColumnRecombination.h"
+#include "CgMasterBase.h"
+#include "TripChains.h"
+
+#include "Instance.h"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <utility>
+
+#include <omp.h>
+
+using namespace std;
+
+ColumnRecombination::ColumnRecombination(const Instance &inst, int maxColumns): m_inst(&inst), m_maxColumns(maxColumns) {
+   // Empty
+}
+
+ColumnRecombination::~ColumnRecombination() {
+   // Empty
+}
+
+auto ColumnRecombination::setTripChains(const TripChains *chains) noexcept -> void {
+   m_chains = chains;
+}
+
+auto ColumnRecombination::generate(CgMasterBase &master) noexcept -> int {
+   const int N = m_inst->numTrips();
+   const int K = m_inst->numDepots();
+   const double minRedCost = -0.0001;
+
+   vector<double> tripDual(N), capDual(K);
+   for (int i = 0; i < N; ++i)
+      tripDual[i] = master.getTripDual(i);
+   for (int k = 0; k < K; ++k)
+      capDual[k] = master.getDepotCapDual(k);
+
+   // Snapshot of the columns in the solution of the RMP.
+   m_depot.clear();
+   m_start.assign(1, 0);
+   m_trips.clear();
+   for (int col = 0; col < master.numColumns(); ++col) {
+      if (master.getValue(col) <= 1e-6)
+         continue;
+      const auto &path = master.columnPath(col);
+      m_depot.push_back(master.columnDepot(col));
+      m_trips.insert(m_trips.end(), path.begin(), path.end());
+      m_start.push_back(m_trips.size());
+   }
+   const int numCols = m_depot.size();
+
+   // Reduced costs of the heads and tails of the columns.
+   m_headCost.resize(m_trips.size());
+   m_tailCost.resize(m_trips.size());
+   for (int c = 0; c < numCols; ++c) {
+      double acc = 0.0;
+      for (int pos = m_start[c]; pos < m_start[c + 1]; ++pos) {
+         if (pos > m_start[c])
+            acc += m_inst->deadheadCost(m_trips[pos - 1], m_trips[pos]);
+         acc -= tripDual[m_trips[pos]];
+         m_headCost[pos] = acc;
+      }
+      acc = 0.0;
+      for (int pos = m_start[c + 1] - 1; pos >= m_start[c]; --pos) {
+         if (pos < m_start[c + 1] - 1)
+            acc += m_inst->deadheadCost(m_trips[pos], m_trips[pos + 1]);
+         acc -= tripDual[m_trips[pos]];
+         m_tailCost[pos] = acc;
+      }
+   }
+
+   // Reduced cost of the depot arcs of a path, at the best depot for its endpoints.
+   auto bestDepot = [&](int first, int last, double &cost) {
+      int best = -1;
+      cost = numeric_limits<double>::infinity();
+      for (int k = 0; k < K; ++k) {
+         const auto source = m_inst->sourceCost(k, first);
+         const auto sink = m_inst->sinkCost(k, last);
+         if (source != -1 && sink != -1 && source + sink - capDual[k] < cost) {
+            cost = source + sink - capDual[k];
+            best = k;
+         }
+      }
+      return best;
+   };
+
+   vector<vector<Candidate>> local(omp_get_max_threads());
+   #pragma omp parallel default(shared)
+   {
+      auto &candidates = local[omp_get_thread_num()];
+      #pragma omp for schedule(dynamic, 1)
+      for (int a = 0; a < numCols; ++a) {
+         const int headFirst = m_start[a];
+         const int headLast = m_start[a + 1] - 1;
+
+         // Reassignment of the column to another depot.
+         for (int k = 0; k < K; ++k) {
+            const auto source = m_inst->sourceCost(k, m_trips[headFirst]);
+            const auto sink = m_inst->sinkCost(k, m_trips[headLast]);
+            if (k == m_depot[a] || source == -1 || sink == -1)
+               continue;
+            if (const auto rc = source + sink - capDual[k] + m_headCost[headLast]; rc < minRedCost)
+               candidates.push_back({rc, k, a, headLast, -1, -1});
+         }
+
+         // Heads of column a followed by tails of column b.
+         for (int b = 0; b < numCols; ++b) {
+            double depotCost;
+            const int k = bestDepot(m_trips[headFirst], m_trips[m_start[b + 1] - 1], depotCost);
+            if (b == a || k == -1)
+               continue;
+
+            const int tailFirst = m_start[b];
+            const int len = m_start[b + 1] - tailFirst;
+            const double *tailCost = &m_tailCost[tailFirst];
+            for (int pos = headFirst; pos <= headLast; ++pos) {
+               const int i = m_trips[pos];
+               const double headCost = depotCost + m_headCost[pos];
+               for (int s = 0; s < len; ++s) {
+                  const int j = m_trips[tailFirst + s];
+                  const auto cost = m_inst->deadheadCost(i, j);
+                  if (cost == -1)
+                     continue;
+                  // A chain is only entered by its head, and left by its tail.
+                  if (m_chains && (m_chains->next(i) != -1 ? m_chains->next(i) != j : !m_chains->isHead(j)))
+                     continue;
+                  if (const auto rc = headCost + cost + tailCost[s]; rc < minRedCost)
+                     candidates.push_back({rc, k, a, pos, b, tailFirst + s});
+               }
+            }
+         }
+      }
+   }
+
+   vector<Candidate> candidates;
+   for (auto &l: local)
+      candidates.insert(candidates.end(), l.begin(), l.end());
+   auto byRedCost = [](const Candidate &x, const Candidate &y) {
+      return x.redCost < y.redCost;
+   };
+   // Repeated paths are rare, so a few times the number of columns is enough.
+   if (const size_t keep = 4 * size_t(m_maxColumns); candidates.size() > keep) {
+      nth_element(candidates.begin(), candidates.begin() + keep, candidates.end(), byRedCost);
+      candidates.resize(keep);
+   }
+   sort(candidates.begin(), candidates.end(), byRedCost);
+
+   // Adds the best candidates, skipping repeated paths.
+   set<pair<int, vector<int>>> added;
+   for (const auto &cand: candidates) {
+      if (int(added.size()) >= m_maxColumns)
+         break;
+      vector<int> path(m_trips.begin() + m_start[cand.head], m_trips.begin() + cand.headEnd + 1);
+      if (cand.tail != -1)
+         path.insert(path.end(), m_trips.begin() + cand.tailStart, m_trips.begin() + m_start[cand.tail + 1]);
+      if (!added.emplace(cand.depot, path).second)
+         continue;
+
+      master.beginColumn(cand.depot);
+      for (int trip: path)
+         master.addTrip(trip);
+      master.commitColumn();
+   }
+
+   return added.size();
+}
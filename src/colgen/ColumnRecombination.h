@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+class Instance;
+class CgMasterBase;
+class TripChains;
+
+/**
+ * @brief Column generation heuristic recombining the columns of the RMP solution.
+ *
+ * The candidates are the paths made of the head of a column followed by the tail
+ * of another one, served by the best depot for their endpoints, and the columns
+ * reassigned to another depot. Candidates are scored against the current duals,
+ * from prefix sums of the reduced costs along each column, and the ones of
+ * negative reduced cost are added into the RMP. It is cheap compared to the
+ * pricing, which only needs to run when recombination finds nothing.
+ */
+class ColumnRecombination {
+public:
+   // Adds up to `maxColumns` columns per call.
+   ColumnRecombination(const Instance &inst, int maxColumns);
+   virtual ~ColumnRecombination();
+
+   // Sets the contraction of forced trip sequences used by the master problem. Paths
+   // that break a chain are not created.
+   auto setTripChains(const TripChains *chains) noexcept -> void;
+
+   // Recombines the columns with positive value in the current solution of `master`.
+   // Returns the number of columns added.
+   auto generate(CgMasterBase &master) noexcept -> int;
+
+private:
+   struct Candidate {
+      double redCost;
+      int depot;
+      int head, headEnd;   // column, and position in m_trips of the last trip of the head
+      int tail, tailStart; // column (-1 for reassignments), and position of the first trip of the tail
+   };
+
+   const Instance *m_inst;
+   int m_maxColumns;
+   const TripChains *m_chains{nullptr};
+
+   // Columns with positive value, stored as in CgMasterBase::addColumns().
+   std::vector<int> m_depot;
+   std::vector<int> m_start;
+   std::vector<int> m_trips;
+
+   // [m_start[c] + pos] -> reduced cost of the trips of column c up to `pos`
+   // (head), and from `pos` onwards (tail), including the deadheads between them.
+   std::vector<double> m_headCost;
+   std::vector<double> m_tailCost;
+};
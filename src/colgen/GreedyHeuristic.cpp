@@ -0,0 +1,167 @@
+#include "GreedyHeuristic.h"
+#include "CgMasterBase.h"
+
+#include "Instance.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#include <omp.h>
+
+using namespace std;
+
+GreedyHeuristic::GreedyHeuristic(const Instance &inst): m_inst(&inst) {
+   m_objValue = numeric_limits<double>::infinity();
+   m_numCovered = 0;
+}
+
+GreedyHeuristic::~GreedyHeuristic() {
+   // Empty
+}
+
+auto GreedyHeuristic::solve(int numStarts) noexcept -> bool {
+   // Ties are broken by the index of the start, so the schedule kept does not depend on
+   // the order in which the threads finish.
+   int bestStart = numStarts;
+
+   #pragma omp parallel for default(shared) schedule(dynamic, 1)
+   for (int start = 0; start < numStarts; ++start) {
+      vector<Vehicle> schedule;
+      double cost;
+      const int covered = construct(start, start == 0 ? 0.0 : 0.1, schedule, cost);
+
+      #pragma omp critical
+      {
+         if (covered > m_numCovered || (covered == m_numCovered && (cost < m_objValue || (cost == m_objValue && start < bestStart)))) {
+            bestStart = start;
+            m_numCovered = covered;
+            m_objValue = cost;
+            m_schedule.swap(schedule);
+         }
+      }
+   }
+
+   return isFeasible();
+}
+
+auto GreedyHeuristic::isFeasible() const noexcept -> bool {
+   return m_numCovered == m_inst->numTrips();
+}
+
+auto GreedyHeuristic::getObjValue() const noexcept -> double {
+   return m_objValue;
+}
+
+auto GreedyHeuristic::getSchedule() const noexcept -> const std::vector<Vehicle> & {
+   return m_schedule;
+}
+
+auto GreedyHeuristic::addColumns(CgMasterBase &master) const noexcept -> int {
+   for (const auto &v: m_schedule) {
+      master.beginColumn(v.depot);
+      for (int trip: v.trips)
+         master.addTrip(trip);
+      master.commitColumn();
+   }
+   return m_schedule.size();
+}
+
+auto GreedyHeuristic::construct(unsigned seed, double alpha, std::vector<Vehicle> &schedule, double &cost) const noexcept -> int {
+   const auto N = m_inst->numTrips();
+   const auto K = m_inst->numDepots();
+
+   mt19937 rng{seed};
+   schedule.clear();
+   cost = 0.0;
+
+   // [trip] -> vehicle ending at the trip, or -1
+   vector<int> endOf(N, -1);
+   vector<int> used(K, 0);
+   int covered = 0;
+
+   // Cost of returning to depot `k` after trip `i`. A vehicle may end at a trip without
+   // sink arc while the trip has successors, as long as it is extended later on. These
+   // ends are charged as the dummy columns of the master, so they are only used when 
+   // needed, and extended as soon as possible.
+   const double openEndCost = 1e7;
+   auto closeCost = [&](int k, int i) {
+      const auto sink = m_inst->sinkCost(k, i);
+      return sink != -1 ? double(sink) : openEndCost;
+   };
+   auto canEnd = [&](int k, int j) {
+      return m_inst->sinkCost(k, j) != -1 || !m_inst->deadheadSuccAdj(k, j).empty();
+   };
+
+   struct Candidate {
+      int vehicle; // -1 for new vehicles
+      int depot;
+      double delta;
+   };
+   vector<Candidate> candidates;
+
+   for (int j: m_inst->topologicalOrder()) {
+      candidates.clear();
+
+      // Appending to an existing vehicle. The vehicle must remain able to 
+      // return to its depot, now or after some other trip.
+      for (int k = 0; k < K; ++k) {
+         if (!canEnd(k, j))
+            continue;
+         for (auto &[i, dh]: m_inst->deadheadPredAdj(k, j)) {
+            if (auto v = endOf[i]; v != -1 && schedule[v].depot == k) {
+               candidates.push_back({v, k, dh + closeCost(k, j) - closeCost(k, i)});
+            }
+         }
+      }
+
+      // Opening a new vehicle.
+      for (int k = 0; k < K; ++k) {
+         const auto source = m_inst->sourceCost(k, j);
+         if (source != -1 && canEnd(k, j) && used[k] < m_inst->depotCapacity(k))
+            candidates.push_back({-1, k, source + closeCost(k, j)});
+      }
+
+      if (candidates.empty())
+         continue;
+
+      // Restricted candidate list with the `alpha` fraction of the best candidates.
+      sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+         return a.delta < b.delta;
+      });
+      const auto rclSize = max<size_t>(1, candidates.size() * alpha);
+      const auto &chosen = candidates[uniform_int_distribution<size_t>(0, rclSize - 1)(rng)];
+
+      int v = chosen.vehicle;
+      if (v == -1) {
+         v = schedule.size();
+         schedule.push_back({chosen.depot, {}});
+         ++used[chosen.depot];
+      } else {
+         endOf[schedule[v].trips.back()] = -1;
+      }
+      schedule[v].trips.push_back(j);
+      endOf[j] = v;
+      ++covered;
+   }
+
+   // Vehicles still ending at a trip without sink arc are closed at their last trip
+   // that has one. The trips after it are left uncovered.
+   for (auto &veh: schedule) {
+      while (!veh.trips.empty() && m_inst->sinkCost(veh.depot, veh.trips.back()) == -1) {
+         veh.trips.pop_back();
+         --covered;
+      }
+   }
+   schedule.erase(remove_if(schedule.begin(), schedule.end(), [](const Vehicle &veh) {
+      return veh.trips.empty();
+   }), schedule.end());
+
+   for (const auto &veh: schedule) {
+      cost += m_inst->sourceCost(veh.depot, veh.trips.front()) + m_inst->sinkCost(veh.depot, veh.trips.back());
+      for (size_t pos = 0; pos + 1 < veh.trips.size(); ++pos)
+         cost += m_inst->deadheadCost(veh.trips[pos], veh.trips[pos + 1]);
+   }
+
+   return covered;
+}
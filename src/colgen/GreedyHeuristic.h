@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+class Instance;
+class CgMasterBase;
+
+/**
+ * @brief Constructive heuristic for building an initial solution to the MDVSP.
+ * 
+ * Trips are processed in topological order. Each trip is either appended to the
+ * vehicle whose last trip connects to it at the smallest cost increase, or starts
+ * a new vehicle at a depot with remaining capacity. A vehicle may end at a trip
+ * without sink arc while the trip has successors; vehicles never extended from such
+ * trips are cut back to their last trip with a sink arc. The first construction is
+ * purely greedy; the remaining ones choose randomly among the best candidates.
+ * Constructions run in parallel, and the best schedule is kept (ties go to the
+ * earliest construction).
+ */
+class GreedyHeuristic {
+public:
+   struct Vehicle {
+      int depot;
+      std::vector<int> trips;
+   };
+
+   GreedyHeuristic(const Instance &inst);
+   virtual ~GreedyHeuristic();
+
+   // Runs `numStarts` constructions. Returns true if all trips are covered by 
+   // the best schedule found.
+   auto solve(int numStarts) noexcept -> bool;
+
+   auto isFeasible() const noexcept -> bool;
+   auto getObjValue() const noexcept -> double;
+   auto getSchedule() const noexcept -> const std::vector<Vehicle> &;
+
+   // Adds one column per vehicle of the best schedule into the master problem.
+   auto addColumns(CgMasterBase &master) const noexcept -> int;
+
+private:
+   const Instance *m_inst;
+
+   std::vector<Vehicle> m_schedule;
+   double m_objValue;
+   int m_numCovered;
+
+   // Builds a schedule. Returns the number of trips covered, and the cost of the schedule.
+   auto construct(unsigned seed, double alpha, std::vector<Vehicle> &schedule, double &cost) const noexcept -> int;
+};
@@ -0,0 +1,235 @@
+#include "LagrangianMaster.h"
+#include "CgPricingBase.h"
+
+#include "Instance.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+using namespace std;
+
+namespace {
+   constexpr double Infinity = numeric_limits<double>::infinity();
+
+   // Scale of the Polyak step, halved after a number of iterations without improving
+   // the bound. The method stops once the scale gets too small.
+   constexpr double InitialStepScale = 2.0;
+   constexpr double MinStepScale = 1e-4;
+   constexpr int StepScalePatience = 100;
+}
+
+LagrangianMaster::LagrangianMaster(const Instance &inst): CgMasterBase(inst) {
+   m_multipliers.assign(m_inst->numTrips(), 0.0);
+   m_bestMultipliers = m_multipliers;
+   m_bestBound = -Infinity;
+}
+
+LagrangianMaster::~LagrangianMaster() {
+   // Empty
+}
+
+auto LagrangianMaster::getSolverName() const noexcept -> std::string {
+   return "Lagrangian relaxation (subgradient)";
+}
+
+// There is no LP model behind the relaxation.
+auto LagrangianMaster::writeLp(const char *) const noexcept -> void {
+   // Empty
+}
+
+auto LagrangianMaster::clone() const noexcept -> std::unique_ptr<CgMasterBase> {
+   return unique_ptr<CgMasterBase>(new LagrangianMaster(*this));
+}
+
+auto LagrangianMaster::solve(const char) noexcept -> double {
+   m_objValue = accumulate(m_multipliers.begin(), m_multipliers.end(), 0.0);
+   for (int k = 0; k < int(m_pricingObj.size()); ++k)
+      m_objValue += m_inst->depotCapacity(k) * min(0.0, m_pricingObj[k]);
+   return m_objValue;
+}
+
+auto LagrangianMaster::setObjLimit(double) noexcept -> void {
+   // Empty
+}
+
+auto LagrangianMaster::getBasis() const noexcept -> Basis {
+   return Basis();
+}
+
+auto LagrangianMaster::setBasis(const Basis &) noexcept -> void {
+   // Empty
+}
+
+auto LagrangianMaster::getObjValue() const noexcept -> double {
+   return m_objValue;
+}
+
+auto LagrangianMaster::getTripDual(int i) const noexcept -> double {
+   assert(i >= 0 && i < m_inst->numTrips());
+   return m_multipliers[i];
+}
+
+// The capacity rows are not relaxed.
+auto LagrangianMaster::getDepotCapDual(int) const noexcept -> double {
+   return 0.0;
+}
+
+auto LagrangianMaster::setAssignmentType(char sense) noexcept -> void {
+   m_freeMultipliers = sense == 'E';
+   if (!m_freeMultipliers) {
+      for (auto &pi: m_multipliers)
+         pi = max(0.0, pi);
+   }
+}
+
+auto LagrangianMaster::getValue(int) const noexcept -> double {
+   return 0.0;
+}
+
+auto LagrangianMaster::getLb(int) const noexcept -> double {
+   return 0.0;
+}
+
+auto LagrangianMaster::setLb(int, double) noexcept -> void {
+   // Empty
+}
+
+auto LagrangianMaster::convertToBinary() noexcept -> void {
+   // Empty
+}
+
+auto LagrangianMaster::convertToRelaxed() noexcept -> void {
+   // Empty
+}
+
+auto LagrangianMaster::optimize(vector<unique_ptr<CgPricingBase>> &pricing, int maxIterations, double upperBound,
+   int numThreads) noexcept -> double {
+   const int N = m_inst->numTrips();
+   m_pricingObj.assign(m_inst->numDepots(), 0.0);
+
+   // With an upper bound, the multipliers start at the mean cost of a trip in its
+   // solution, otherwise at zero and the first step scales them to the target.
+   if (upperBound < Infinity && m_numIterations == 0)
+      fill(m_multipliers.begin(), m_multipliers.end(), upperBound / N);
+
+   vector<double> subgradient(N);
+   double stepScale = InitialStepScale;
+   int sinceImprovement = 0;
+   for (m_numIterations = 0; m_numIterations < maxIterations && !MdvspSigInt; ) {
+      #pragma omp parallel for default(shared) schedule(static, 1) num_threads(numThreads)
+      for (size_t i = 0; i < pricing.size(); ++i)
+         pricing[i]->solve();
+
+      // Each depot with an improving path sends all of its vehicles along its best path.
+      fill(subgradient.begin(), subgradient.end(), 1.0);
+      for (auto &sp: pricing) {
+         const int k = sp->depotId();
+         m_pricingObj[k] = sp->getObjValue();
+         if (m_pricingObj[k] > -0.0001)
+            continue;
+
+         const int first = numColumns();
+         sp->generateColumns();
+         int best = -1;
+         double bestRedCost = Infinity;
+         for (int c = first; c < numColumns(); ++c) {
+            double redCost = m_colCost[c];
+            for (int i: m_colTrips[c])
+               redCost -= m_multipliers[i];
+            if (redCost < bestRedCost) {
+               bestRedCost = redCost;
+               best = c;
+            }
+         }
+         if (best == -1)
+            continue;
+         for (int i: m_colTrips[best])
+            subgradient[i] -= m_inst->depotCapacity(k);
+
+         // Only the best path is kept, once.
+         int end = first;
+         if (m_seen.emplace(m_colDepot[best], m_colTrips[best]).second) {
+            swap(m_colDepot[first], m_colDepot[best]);
+            swap(m_colTrips[first], m_colTrips[best]);
+            swap(m_colCost[first], m_colCost[best]);
+            ++end;
+         }
+         m_colDepot.resize(end);
+         m_colTrips.resize(end);
+         m_colCost.resize(end);
+         m_numCols = end;
+      }
+      ++m_numIterations;
+
+      const double bound = solve();
+      if (bound > m_bestBound) {
+         m_bestBound = bound;
+         m_bestMultipliers = m_multipliers;
+         sinceImprovement = 0;
+      } else if (++sinceImprovement >= StepScalePatience) {
+         stepScale /= 2.0;
+         sinceImprovement = 0;
+      }
+
+      // Costs are integer, so the upper bound is optimal once the bound is within one.
+      if (upperBound < Infinity && ceil(m_bestBound - 1e-6) >= upperBound)
+         break;
+      double norm = 0.0;
+      for (int i = 0; i < N; ++i) {
+         if (!m_freeMultipliers && m_multipliers[i] <= 0.0 && subgradient[i] < 0.0)
+            subgradient[i] = 0.0;
+         norm += subgradient[i] * subgradient[i];
+      }
+      // A null subgradient means the relaxed solution is feasible, hence optimal.
+      if (norm < 1e-12 || stepScale < MinStepScale)
+         break;
+
+      // Polyak step towards the target value.
+      const double target = upperBound < Infinity ? upperBound : m_bestBound + 0.01 * fabs(m_bestBound) + 1.0;
+      const double step = stepScale * (target - bound) / norm;
+      for (int i = 0; i < N; ++i) {
+         m_multipliers[i] += step * subgradient[i];
+         if (!m_freeMultipliers)
+            m_multipliers[i] = max(0.0, m_multipliers[i]);
+      }
+   }
+
+   return m_bestBound;
+}
+
+auto LagrangianMaster::getBestBound() const noexcept -> double {
+   return m_bestBound;
+}
+
+auto LagrangianMaster::numIterations() const noexcept -> int {
+   return m_numIterations;
+}
+
+auto LagrangianMaster::addColumnsTo(CgMasterBase &master, int maxColumns) const noexcept -> int {
+   vector<pair<double, int>> byRedCost;
+   for (int c = 0; c < numColumns(); ++c) {
+      double redCost = m_colCost[c];
+      for (int i: m_colTrips[c])
+         redCost -= m_bestMultipliers[i];
+      byRedCost.emplace_back(redCost, c);
+   }
+   const int numCols = min<int>(maxColumns, byRedCost.size());
+   partial_sort(byRedCost.begin(), byRedCost.begin() + numCols, byRedCost.end());
+
+   vector<int> depots, start{0}, trips;
+   for (int pos = 0; pos < numCols; ++pos) {
+      const int c = byRedCost[pos].second;
+      depots.push_back(m_colDepot[c]);
+      trips.insert(trips.end(), m_colTrips[c].begin(), m_colTrips[c].end());
+      start.push_back(trips.size());
+   }
+   return master.addColumns(numCols, depots.data(), start.data(), trips.data());
+}
+
+// Columns are kept in the pool of the base class only.
+auto LagrangianMaster::addColumn() noexcept -> void {
+   // Empty
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CgMasterBase.h"
+
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+class CgPricingBase;
+
+/**
+ * @brief Lagrangian relaxation of the trip assignment rows, solved by subgradient.
+ *
+ * Relaxing the assignment rows leaves one shortest path problem per depot, which are
+ * the pricing subproblems of the column generation. This class stands for the master
+ * problem of those subproblems: its "duals" are the Lagrangian multipliers, and it
+ * keeps the best path found by each subproblem in every iteration. The columns of
+ * least reduced cost at the best multipliers can then seed the RMP, so the column
+ * generation starts from duals close to the optimal ones.
+ *
+ * Depot capacity rows are kept in the subproblems: a depot uses all of its vehicles
+ * in its best path when the path has negative reduced cost, and none otherwise.
+ */
+class LagrangianMaster: public CgMasterBase {
+public:
+   LagrangianMaster(const Instance &inst);
+   virtual ~LagrangianMaster();
+
+   virtual auto getSolverName() const noexcept -> std::string override;
+   virtual auto writeLp(const char *fname) const noexcept -> void override;
+   virtual auto clone() const noexcept -> std::unique_ptr<CgMasterBase> override;
+
+   // Evaluates the Lagrangian function at the current multipliers, from the objective
+   // values of the last solve of the subproblems. `algo` is ignored.
+   virtual auto solve(const char algo = 'p') noexcept -> double override;
+   virtual auto setObjLimit(double limit) noexcept -> void override;
+   virtual auto getBasis() const noexcept -> Basis override;
+   virtual auto setBasis(const Basis &basis) noexcept -> void override;
+   virtual auto getObjValue() const noexcept -> double override;
+   virtual auto getTripDual(int i) const noexcept -> double override;
+   virtual auto getDepotCapDual(int k) const noexcept -> double override;
+
+   // With 'G' the multipliers are kept non-negative, with 'E' they are free. 'E' by
+   // default, which relaxes the set partitioning problem.
+   virtual auto setAssignmentType(char sense = 'G') noexcept -> void override;
+
+   virtual auto getValue(int col) const noexcept -> double override;
+   virtual auto getLb(int col) const noexcept -> double override;
+   virtual auto setLb(int col, double bound) noexcept -> void override;
+
+   virtual auto convertToBinary() noexcept -> void override;
+   virtual auto convertToRelaxed() noexcept -> void override;
+
+   // Runs up to `maxIterations` iterations of the subgradient method, with subproblems
+   // created over this master. The steps aim at `upperBound`, or at a guess above the
+   // best bound when it is infinite. Returns the best Lagrangian bound, which is only
+   // valid when the subproblems are exact.
+   auto optimize(std::vector<std::unique_ptr<CgPricingBase>> &pricing, int maxIterations, double upperBound,
+      int numThreads) noexcept -> double;
+
+   auto getBestBound() const noexcept -> double;
+   auto numIterations() const noexcept -> int;
+
+   // Adds into `master` up to `maxColumns` columns, the ones of least reduced cost at
+   // the best multipliers. Returns the number of columns added.
+   auto addColumnsTo(CgMasterBase &master, int maxColumns) const noexcept -> int;
+
+private:
+   std::vector<double> m_multipliers;
+   std::vector<double> m_bestMultipliers;
+   bool m_freeMultipliers{true};
+   double m_objValue{0.0};
+   double m_bestBound;
+   int m_numIterations{0};
+
+   // Objective values of the subproblems, set by optimize() before calling solve().
+   std::vector<double> m_pricingObj;
+
+   // Columns already kept, to skip the paths found again.
+   std::set<std::pair<int, std::vector<int>>> m_seen;
+
+   virtual auto addColumn() noexcept -> void override;
+};
@@ -0,0 +1,274 @@
+#include "LocalSearch.h"
+#include "CgMasterBase.h"
+
+#include "Instance.h"
+
+#include <algorithm>
+
+using namespace std;
+
+LocalSearch::LocalSearch(const Instance &inst, const vector<pair<int, vector<int>>> &schedule): m_inst(&inst) {
+   m_used.assign(m_inst->numDepots(), 0);
+   for (const auto &[k, trips]: schedule) {
+      if (trips.empty())
+         continue;
+      m_vehicles.push_back({k, trips, {}, false});
+      updatePrefix(m_vehicles.back());
+      m_objValue += vehicleCost(m_vehicles.back());
+      ++m_used[k];
+   }
+}
+
+LocalSearch::~LocalSearch() {
+   // Empty
+}
+
+auto LocalSearch::improve(int maxRounds) noexcept -> int {
+   int numMoves = 0;
+   for (int round = 0; round < maxRounds; ++round) {
+      const int V = m_vehicles.size();
+
+      // Best move of each vehicle with the vehicles after it.
+      vector<Move> best(V);
+      #pragma omp parallel for default(shared) schedule(dynamic, 1)
+      for (int a = 0; a < V; ++a) {
+         auto &move = best[a];
+         const auto &A = m_vehicles[a];
+         const auto costA = vehicleCost(A);
+         const int last = A.trips.size() - 1;
+         for (int k = 0; k < m_inst->numDepots(); ++k) {
+            if (k == A.depot || m_used[k] >= m_inst->depotCapacity(k))
+               continue;
+            if (const auto cost = joinCost(k, A, last, A, last); cost != -1 && cost - costA < move.delta)
+               move = {Move::Reassign, a, k, -1, -1, cost - costA};
+         }
+         for (int b = a + 1; b < V; ++b)
+            evalPair(a, b, move);
+      }
+
+      // Applies the best moves first, skipping the moves of vehicles already changed.
+      vector<Move> moves;
+      for (auto &m: best) {
+         if (m.delta < 0)
+            moves.push_back(m);
+      }
+      if (moves.empty())
+         break;
+      sort(moves.begin(), moves.end(), [](const Move &x, const Move &y) { return x.delta < y.delta; });
+
+      vector<char> touched(V, 0);
+      for (const auto &m: moves) {
+         if (m.type == Move::Reassign) {
+            if (touched[m.a] || m_used[m.b] >= m_inst->depotCapacity(m.b))
+               continue;
+         } else if (touched[m.a] || touched[m.b]) {
+            continue;
+         }
+         apply(m);
+         touched[m.a] = 1;
+         if (m.type != Move::Reassign)
+            touched[m.b] = 1;
+         ++numMoves;
+      }
+
+      // Removes the vehicles left without trips.
+      for (auto &v: m_vehicles) {
+         if (v.trips.empty())
+            --m_used[v.depot];
+      }
+      m_vehicles.erase(remove_if(m_vehicles.begin(), m_vehicles.end(), [](const Vehicle &v) { return v.trips.empty(); }),
+         m_vehicles.end());
+   }
+
+   return numMoves;
+}
+
+auto LocalSearch::getObjValue() const noexcept -> double {
+   return m_objValue;
+}
+
+auto LocalSearch::getSchedule() const noexcept -> vector<pair<int, vector<int>>> {
+   vector<pair<int, vector<int>>> schedule;
+   for (const auto &v: m_vehicles)
+      schedule.emplace_back(v.depot, v.trips);
+   return schedule;
+}
+
+auto LocalSearch::addColumns(CgMasterBase &master) const noexcept -> int {
+   int numCols = 0;
+   for (const auto &v: m_vehicles) {
+      if (!v.changed)
+         continue;
+      master.beginColumn(v.depot);
+      for (int trip: v.trips)
+         master.addTrip(trip);
+      master.commitColumn();
+      ++numCols;
+   }
+   return numCols;
+}
+
+auto LocalSearch::link(int k, int i, int j) const noexcept -> long {
+   if (i == -1 && j == -1)
+      return 0;
+   if (i == -1)
+      return m_inst->sourceCost(k, j);
+   if (j == -1)
+      return m_inst->sinkCost(k, i);
+   return m_inst->deadheadCost(i, j);
+}
+
+auto LocalSearch::vehicleCost(const Vehicle &v) const noexcept -> long {
+   if (v.trips.empty())
+      return 0;
+   return link(v.depot, -1, v.trips.front()) + v.prefix.back() + link(v.depot, v.trips.back(), -1);
+}
+
+auto LocalSearch::updatePrefix(Vehicle &v) const noexcept -> void {
+   v.prefix.resize(v.trips.size());
+   for (size_t pos = 0; pos < v.trips.size(); ++pos)
+      v.prefix[pos] = pos == 0 ? 0 : v.prefix[pos - 1] + m_inst->deadheadCost(v.trips[pos - 1], v.trips[pos]);
+}
+
+auto LocalSearch::joinCost(int k, const Vehicle &h, int p, const Vehicle &t, int q) const noexcept -> long {
+   const bool hasHead = p >= 0;
+   const bool hasTail = q + 1 < int(t.trips.size());
+   if (!hasHead && !hasTail)
+      return 0;
+
+   const auto source = link(k, -1, hasHead ? h.trips.front() : t.trips[q + 1]);
+   const auto sink = link(k, hasTail ? t.trips.back() : h.trips[p], -1);
+   if (source == -1 || sink == -1)
+      return -1;
+   long cost = source + sink;
+   if (hasHead)
+      cost += h.prefix[p];
+   if (hasTail)
+      cost += t.prefix.back() - t.prefix[q + 1];
+   if (hasHead && hasTail) {
+      const auto dh = link(k, h.trips[p], t.trips[q + 1]);
+      if (dh == -1)
+         return -1;
+      cost += dh;
+   }
+   return cost;
+}
+
+auto LocalSearch::evalPair(int a, int b, Move &best) const noexcept -> void {
+   const auto &A = m_vehicles[a];
+   const auto &B = m_vehicles[b];
+   const int La = A.trips.size();
+   const int Lb = B.trips.size();
+   const auto costA = vehicleCost(A);
+   const auto costB = vehicleCost(B);
+
+   // Tails swap: A keeps A[0..p] followed by B[q+1..], and B keeps B[0..q] followed
+   // by A[p+1..]. Swapping whole vehicles exchanges their depots.
+   for (int p = -1; p < La; ++p) {
+      for (int q = -1; q < Lb; ++q) {
+         if (p == La - 1 && q == Lb - 1)
+            continue;
+         const auto newA = joinCost(A.depot, A, p, B, q);
+         if (newA == -1)
+            continue;
+         const auto newB = joinCost(B.depot, B, q, A, p);
+         if (newB == -1)
+            continue;
+         if (const auto delta = newA + newB - costA - costB; delta < best.delta)
+            best = {Move::TailSwap, a, b, p, q, delta};
+      }
+   }
+
+   // Neighbors of position `pos` of a vehicle, -1 standing for the depot.
+   auto prev = [](const Vehicle &v, int pos) { return pos > 0 ? v.trips[pos - 1] : -1; };
+   auto next = [](const Vehicle &v, int pos) { return pos + 1 < int(v.trips.size()) ? v.trips[pos + 1] : -1; };
+
+   // Relocation of X[p] into Y, after Y[q].
+   auto relocate = [&](int x, int y) {
+      const auto &X = m_vehicles[x];
+      const auto &Y = m_vehicles[y];
+      const int Lx = X.trips.size();
+      const int Ly = Y.trips.size();
+      for (int p = 0; p < Lx; ++p) {
+         const int t = X.trips[p];
+         long removal = -vehicleCost(X);
+         if (Lx > 1) {
+            const auto bypass = link(X.depot, prev(X, p), next(X, p));
+            if (bypass == -1)
+               continue;
+            removal = bypass - link(X.depot, prev(X, p), t) - link(X.depot, t, next(X, p));
+         }
+         for (int q = -1; q < Ly; ++q) {
+            const int i = q >= 0 ? Y.trips[q] : -1;
+            const int j = q + 1 < Ly ? Y.trips[q + 1] : -1;
+            const auto in = link(Y.depot, i, t);
+            const auto out = link(Y.depot, t, j);
+            if (in == -1 || out == -1)
+               continue;
+            if (const auto delta = removal + in + out - link(Y.depot, i, j); delta < best.delta)
+               best = {Move::Relocate, x, y, p, q, delta};
+         }
+      }
+   };
+   relocate(a, b);
+   relocate(b, a);
+
+   // Exchange of A[p] and B[q].
+   for (int p = 0; p < La; ++p) {
+      const int t = A.trips[p];
+      const auto oldA = link(A.depot, prev(A, p), t) + link(A.depot, t, next(A, p));
+      for (int q = 0; q < Lb; ++q) {
+         const int u = B.trips[q];
+         const auto inA = link(A.depot, prev(A, p), u);
+         const auto outA = link(A.depot, u, next(A, p));
+         if (inA == -1 || outA == -1)
+            continue;
+         const auto inB = link(B.depot, prev(B, q), t);
+         const auto outB = link(B.depot, t, next(B, q));
+         if (inB == -1 || outB == -1)
+            continue;
+         const auto oldB = link(B.depot, prev(B, q), u) + link(B.depot, u, next(B, q));
+         if (const auto delta = inA + outA - oldA + inB + outB - oldB; delta < best.delta)
+            best = {Move::Exchange, a, b, p, q, delta};
+      }
+   }
+}
+
+auto LocalSearch::apply(const Move &m) noexcept -> void {
+   auto &A = m_vehicles[m.a];
+   switch (m.type) {
+      case Move::Reassign:
+         --m_used[A.depot];
+         ++m_used[m.b];
+         A.depot = m.b;
+         break;
+      case Move::Relocate: {
+         auto &B = m_vehicles[m.b];
+         B.trips.insert(B.trips.begin() + m.q + 1, A.trips[m.p]);
+         A.trips.erase(A.trips.begin() + m.p);
+         break;
+      }
+      case Move::Exchange:
+         swap(A.trips[m.p], m_vehicles[m.b].trips[m.q]);
+         break;
+      case Move::TailSwap: {
+         auto &B = m_vehicles[m.b];
+         vector<int> newA(A.trips.begin(), A.trips.begin() + m.p + 1);
+         newA.insert(newA.end(), B.trips.begin() + m.q + 1, B.trips.end());
+         B.trips.resize(m.q + 1);
+         B.trips.insert(B.trips.end(), A.trips.begin() + m.p + 1, A.trips.end());
+         A.trips.swap(newA);
+         break;
+      }
+      case Move::None:
+         return;
+   }
+
+   updatePrefix(A);
+   A.changed = true;
+   if (m.type != Move::Reassign) {
+      updatePrefix(m_vehicles[m.b]);
+      m_vehicles[m.b].changed = true;
+   }
+   m_objValue += m.delta;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+class Instance;
+class CgMasterBase;
+
+/**
+ * @brief Local search improving a schedule of the MDVSP.
+ *
+ * Each round evaluates, for every pair of vehicles, the relocation of a trip into
+ * the other vehicle, the exchange of two trips, and the swap of the tails of both
+ * vehicles (2-opt), along with moving single vehicles to another depot with spare
+ * capacity. Costs of moves are computed in constant time from prefix sums of the
+ * deadheading costs of each vehicle. Vehicles are evaluated in parallel, and the
+ * best improving moves touching disjoint vehicles are applied at the end of the
+ * round. Vehicles emptied by the moves are removed.
+ */
+class LocalSearch {
+public:
+   // Starts from a schedule given as (depot, trips) vehicles.
+   LocalSearch(const Instance &inst, const std::vector<std::pair<int, std::vector<int>>> &schedule);
+   virtual ~LocalSearch();
+
+   // Runs up to `maxRounds` rounds, stopping when no move improves the schedule.
+   // Returns the number of moves applied.
+   auto improve(int maxRounds) noexcept -> int;
+
+   auto getObjValue() const noexcept -> double;
+   auto getSchedule() const noexcept -> std::vector<std::pair<int, std::vector<int>>>;
+
+   // Adds one column per vehicle changed by the moves into the master problem.
+   auto addColumns(CgMasterBase &master) const noexcept -> int;
+
+private:
+   struct Vehicle {
+      int depot;
+      std::vector<int> trips;
+      // [pos] -> deadheading cost from the first trip up to trips[pos].
+      std::vector<long> prefix;
+      bool changed{false};
+   };
+
+   struct Move {
+      enum Type {None, Relocate, Exchange, TailSwap, Reassign} type{None};
+      int a{-1}, b{-1};    // vehicles; b is the new depot for Reassign
+      int p{-1}, q{-1};    // positions in the vehicles
+      long delta{0};
+   };
+
+   const Instance *m_inst;
+   std::vector<Vehicle> m_vehicles;
+   std::vector<int> m_used;
+   long m_objValue{0};
+
+   // Cost of connecting i to j in a vehicle of depot k, where -1 stands for the
+   // depot. Returns -1 if the connection does not exist.
+   auto link(int k, int i, int j) const noexcept -> long;
+   auto vehicleCost(const Vehicle &v) const noexcept -> long;
+   auto updatePrefix(Vehicle &v) const noexcept -> void;
+
+   // Cost of a vehicle of depot k made of h[0..p] followed by t[q+1..]. Returns -1
+   // if infeasible.
+   auto joinCost(int k, const Vehicle &h, int p, const Vehicle &t, int q) const noexcept -> long;
+
+   // Finds the best moves between vehicles a and b, updating `best`.
+   auto evalPair(int a, int b, Move &best) const noexcept -> void;
+   auto apply(const Move &m) noexcept -> void;
+};
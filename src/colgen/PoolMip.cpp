@@ -0,0 +1,180 @@
+#include "PoolMip.h"
+#include "CgMasterBase.h"
+
+#include "Instance.h"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+#include <coin/CbcModel.hpp>
+#include <coin/OsiClpSolverInterface.hpp>
+
+using namespace std;
+
+PoolMip::PoolMip(const Instance &inst, double interval, double timeLimit): m_inst(&inst), m_interval(interval),
+   m_timeLimit(timeLimit), m_worker(&PoolMip::run, this) {
+}
+
+PoolMip::~PoolMip() {
+   stop();
+}
+
+auto PoolMip::update(const CgMasterBase &master) noexcept -> void {
+   if (master.numColumns() == m_numCopied)
+      return;
+
+   {
+      lock_guard<mutex> lock(m_mutex);
+      for (int col = m_numCopied; col < master.numColumns(); ++col) {
+         const auto &trips = master.columnPath(col);
+         m_newDepot.push_back(master.columnDepot(col));
+         m_newTrips.insert(m_newTrips.end(), trips.begin(), trips.end());
+         m_newStart.push_back(m_newTrips.size());
+         m_newCost.push_back(master.getCost(col));
+      }
+   }
+   m_numCopied = master.numColumns();
+   m_cv.notify_all();
+}
+
+auto PoolMip::setCutoff(double value) noexcept -> void {
+   lock_guard<mutex> lock(m_mutex);
+   m_cutoff = min(m_cutoff, value);
+}
+
+auto PoolMip::stop() noexcept -> void {
+   {
+      lock_guard<mutex> lock(m_mutex);
+      m_stop = true;
+      if (m_model)
+         m_model->sayEventHappened();
+   }
+   m_cv.notify_all();
+   if (m_worker.joinable())
+      m_worker.join();
+}
+
+auto PoolMip::getObjValue() const noexcept -> double {
+   return m_objValue;
+}
+
+auto PoolMip::getSchedule() const noexcept -> vector<pair<int, vector<int>>> {
+   lock_guard<mutex> lock(m_mutex);
+   return m_schedule;
+}
+
+auto PoolMip::numRounds() const noexcept -> int {
+   lock_guard<mutex> lock(m_mutex);
+   return m_numRounds;
+}
+
+auto PoolMip::run() noexcept -> void {
+   using Clock = chrono::steady_clock;
+   const auto interval = chrono::duration_cast<Clock::duration>(chrono::duration<double>(m_interval));
+   auto nextRound = Clock::now() + interval;
+
+   unique_lock<mutex> lock(m_mutex);
+   while (true) {
+      // Waits for the interval to pass, and for new columns.
+      while (!m_stop && (m_newDepot.empty() || Clock::now() < nextRound)) {
+         if (m_newDepot.empty())
+            m_cv.wait(lock);
+         else
+            m_cv.wait_until(lock, nextRound);
+      }
+      if (m_stop)
+         return;
+
+      // Takes the snapshot of the pool.
+      const int offset = m_poolTrips.size();
+      for (size_t c = 0; c < m_newDepot.size(); ++c)
+         m_poolStart.push_back(offset + m_newStart[c + 1]);
+      m_poolDepot.insert(m_poolDepot.end(), m_newDepot.begin(), m_newDepot.end());
+      m_poolTrips.insert(m_poolTrips.end(), m_newTrips.begin(), m_newTrips.end());
+      m_poolCost.insert(m_poolCost.end(), m_newCost.begin(), m_newCost.end());
+      m_newDepot.clear();
+      m_newStart.resize(1);
+      m_newTrips.clear();
+      m_newCost.clear();
+      const double cutoff = min<double>(m_cutoff, m_objValue);
+      lock.unlock();
+
+      vector<pair<int, vector<int>>> schedule;
+      const auto value = solveRound(cutoff, schedule);
+      nextRound = Clock::now() + interval;
+
+      lock.lock();
+      ++m_numRounds;
+      if (value < m_objValue) {
+         m_schedule.swap(schedule);
+         m_objValue = value;
+      }
+   }
+}
+
+auto PoolMip::solveRound(double cutoff, vector<pair<int, vector<int>>> &schedule) noexcept -> double {
+   const int N = m_inst->numTrips();
+   const int K = m_inst->numDepots();
+   const int numCols = m_poolDepot.size();
+
+   // Rows are the trips, covered exactly once, followed by the depot capacities.
+   vector<double> rowLb(N + K, 1.0), rowUb(N + K, 1.0);
+   for (int k = 0; k < K; ++k) {
+      rowLb[N + k] = 0.0;
+      rowUb[N + k] = m_inst->depotCapacity(k);
+   }
+
+   vector<CoinBigIndex> start(numCols + 1);
+   vector<int> index;
+   index.reserve(m_poolTrips.size() + numCols);
+   for (int c = 0; c < numCols; ++c) {
+      start[c] = index.size();
+      index.insert(index.end(), m_poolTrips.begin() + m_poolStart[c], m_poolTrips.begin() + m_poolStart[c + 1]);
+      index.push_back(N + m_poolDepot[c]);
+   }
+   start[numCols] = index.size();
+   vector<double> value(index.size(), 1.0), colLb(numCols, 0.0), colUb(numCols, 1.0);
+
+   OsiClpSolverInterface solver;
+   solver.loadProblem(numCols, N + K, start.data(), index.data(), value.data(), colLb.data(), colUb.data(),
+      m_poolCost.data(), rowLb.data(), rowUb.data());
+   vector<int> columns(numCols);
+   iota(columns.begin(), columns.end(), 0);
+   solver.setInteger(columns.data(), numCols);
+   solver.setLogLevel(0);
+
+   CbcModel model(solver);
+   model.setLogLevel(0);
+   model.setNumberThreads(1);
+   model.setMaximumSeconds(m_timeLimit);
+   // Costs are integral, so only solutions better by at least one are of interest.
+   if (cutoff < numeric_limits<double>::infinity())
+      model.setCutoff(cutoff - 0.5);
+
+   {
+      lock_guard<mutex> lock(m_mutex);
+      if (m_stop)
+         return numeric_limits<double>::infinity();
+      m_model = &model;
+   }
+   model.initialSolve();
+   model.branchAndBound();
+   {
+      lock_guard<mutex> lock(m_mutex);
+      m_model = nullptr;
+   }
+
+   const double *solution = model.bestSolution();
+   if (!solution)
+      return numeric_limits<double>::infinity();
+
+   double cost = 0.0;
+   for (int c = 0; c < numCols; ++c) {
+      if (solution[c] < 0.5)
+         continue;
+      schedule.emplace_back(m_poolDepot[c], vector<int>(m_poolTrips.begin() + m_poolStart[c], m_poolTrips.begin() + m_poolStart[c + 1]));
+      cost += m_poolCost[c];
+   }
+   return cost;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class Instance;
+class CgMasterBase;
+class CbcModel;
+
+/**
+ * @brief Anytime heuristic solving the restricted set partitioning MIP over the
+ * columns generated so far.
+ *
+ * Runs on a helper thread, so the column generation is not stalled. The columns
+ * of the master problem are copied into a pool as they are generated, and every
+ * `interval` seconds the helper solves the MIP over a snapshot of the pool with
+ * CBC, under a short time limit. The best known solution value is used as cutoff,
+ * so only improving solutions are reported.
+ */
+class PoolMip {
+public:
+   PoolMip(const Instance &inst, double interval, double timeLimit);
+
+   // Stops the helper thread.
+   virtual ~PoolMip();
+
+   // Copies the columns added into `master` since the last call. Must be called by
+   // the thread that owns the master problem.
+   auto update(const CgMasterBase &master) noexcept -> void;
+
+   // Value of a known solution, used as cutoff of the next rounds.
+   auto setCutoff(double value) noexcept -> void;
+
+   // Interrupts the current round, and stops the helper thread.
+   auto stop() noexcept -> void;
+
+   // Best solution found, or infinity. Can be called at any time.
+   auto getObjValue() const noexcept -> double;
+   auto getSchedule() const noexcept -> std::vector<std::pair<int, std::vector<int>>>;
+   auto numRounds() const noexcept -> int;
+
+private:
+   const Instance *m_inst;
+   double m_interval;
+   double m_timeLimit;
+
+   // Columns of the pool, stored as in CgMasterBase::addColumns(). Only used by
+   // the helper thread.
+   std::vector<int> m_poolDepot;
+   std::vector<int> m_poolStart{0};
+   std::vector<int> m_poolTrips;
+   std::vector<double> m_poolCost;
+
+   // Columns copied from the master, waiting for the next round.
+   std::vector<int> m_newDepot;
+   std::vector<int> m_newStart{0};
+   std::vector<int> m_newTrips;
+   std::vector<double> m_newCost;
+   int m_numCopied{0};
+
+   std::atomic<double> m_objValue{std::numeric_limits<double>::infinity()};
+   double m_cutoff{std::numeric_limits<double>::infinity()};
+   std::vector<std::pair<int, std::vector<int>>> m_schedule;
+   int m_numRounds{0};
+
+   mutable std::mutex m_mutex;
+   std::condition_variable m_cv;
+   CbcModel *m_model{nullptr};
+   bool m_stop{false};
+   std::thread m_worker;
+
+   auto run() noexcept -> void;
+
+   // Solves the MIP over the pool. Returns the value of the solution found, or infinity.
+   auto solveRound(double cutoff, std::vector<std::pair<int, std::vector<int>>> &schedule) noexcept -> double;
+};
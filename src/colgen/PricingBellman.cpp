@@ -47,6 +47,8 @@ auto PricingBellman::solve() noexcept -> double {
    // about the graph so we can tweak the algorithm for our use case.
    const auto depotDual = m_master->getDepotCapDual(m_depotId);
    for (int i = 0; i < m_inst->numTrips(); ++i) {
+      if (!isNodeActive(i))
+         continue;
       if (auto cost = m_inst->sourceCost(m_depotId, i); cost != -1) {
          m_dist[i] = double(cost) - depotDual;
          m_pred[i] = O;
@@ -57,12 +59,18 @@ auto PricingBellman::solve() noexcept -> double {
       bool changed = false;
 
       for (int i = 0; i < m_inst->numTrips(); ++i) {
-         const auto iDual = m_master->getTripDual(i);
+         if (!isNodeActive(i))
+            continue;
+         const auto iDual = nodeDual(i);
+         const auto iTail = nodeTail(i);
+         const auto iCost = nodeCost(i);
 
          int numExpansions = m_maxLabelExpansions;
-         for (auto &p: m_inst->deadheadSuccAdj(i)) {
+         for (auto &p: deadheadSuccAdj(iTail)) {
             int to = p.first;
-            double len = double(p.second) - iDual;
+            if (!isNodeActive(to))
+               continue;
+            double len = double(p.second + iCost) - iDual;
 
             if (m_dist[i] + len < m_dist[to]) {
                m_dist[to] = m_dist[i] + len;
@@ -74,8 +82,8 @@ auto PricingBellman::solve() noexcept -> double {
             }
          }
 
-         if (auto cost = m_inst->sinkCost(m_depotId, i); cost != -1) {
-            double len = cost - iDual;
+         if (auto cost = m_inst->sinkCost(m_depotId, iTail); cost != -1) {
+            double len = cost + iCost - iDual;
             if (m_dist[i] + len < m_dist[D]) {
                m_dist[D] = m_dist[i] + len;
                m_pred[D] = i;
@@ -112,14 +120,16 @@ auto PricingBellman::generateColumns() const noexcept -> int {
 
    if (m_maxPaths == 1) {
       vector<int> path { m_pred[D] };
-      assert(m_inst->sinkCost(m_depotId, path.back()) != -1);
-      double cost = m_inst->sinkCost(m_depotId, path.back()) - m_master->getTripDual(path.back());
+      assert(m_inst->sinkCost(m_depotId, nodeTail(path.back())) != -1);
+      double cost = m_inst->sinkCost(m_depotId, nodeTail(path.back())) + nodeCost(path.back()) - nodeDual(path.back());
       findPathRecursive(path, cost, allPaths);
    } else {
       for (int i = 0; i < m_inst->numTrips(); ++i) {
-         if (auto cost = m_inst->sinkCost(m_depotId, i); cost != -1) {
+         if (!isNodeActive(i) || m_dist[i] == numeric_limits<double>::infinity())
+            continue;
+         if (auto cost = m_inst->sinkCost(m_depotId, nodeTail(i)); cost != -1) {
             vector<int> path = {i};
-            double pcost = double(cost) - m_master->getTripDual(i);
+            double pcost = double(cost) + nodeCost(i) - nodeDual(i);
             findPathRecursive(path, pcost, allPaths);
          }
       }
@@ -149,8 +159,8 @@ auto PricingBellman::findPathRecursive(std::vector<int> &path, double pcost, std
       return;
    }
 
-   assert(m_inst->deadheadCost(pred, path.back()) != -1);
-   double cst = pcost + (m_inst->deadheadCost(pred, path.back()) - m_master->getTripDual(pred));
+   assert(m_inst->deadheadCost(nodeTail(pred), path.back()) != -1);
+   double cst = pcost + (m_inst->deadheadCost(nodeTail(pred), path.back()) + nodeCost(pred) - nodeDual(pred));
    path.push_back(pred);
    findPathRecursive(path, cst, allPaths);
    path.pop_back();
@@ -6,7 +6,9 @@
 #include <coin/CoinModel.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 
 using namespace std;
 
@@ -31,61 +33,99 @@ auto PricingCbc::isExact() const noexcept -> bool {
 }
 
 auto PricingCbc::solve() noexcept -> double {
-   if (!m_lpSolver)
+   const bool warmStart = m_lpSolver != nullptr;
+   if (!warmStart)
       buildModel();
    const auto O = sourceNode();
    const auto D = sinkNode();
 
-   for (int i = 0; i < m_inst->numTrips(); ++i) {
-      // First updates the source arcs with the duals relative to
-      // the depot capacity.
-      if (int colId = m_x[O][i]; colId != -1) {
-         auto cost = m_inst->sourceCost(m_depotId, i) - m_master->getDepotCapDual(m_depotId);
-         m_lpSolver->setObjCoeff(colId, cost);
-      }
+   // Computes the reduced cost of all arcs, and pushes them at once.
+   for (size_t col = 0; col < m_colArc.size(); ++col) {
+      const auto [i, j] = m_colArc[col];
+      if (i == O)
+         m_obj[col] = m_inst->sourceCost(m_depotId, j) - m_master->getDepotCapDual(m_depotId);
+      else if (j == D)
+         m_obj[col] = m_inst->sinkCost(m_depotId, i) - m_master->getTripDual(i);
+      else
+         m_obj[col] = m_inst->deadheadCost(i, j) - m_master->getTripDual(i);
+   }
+   m_lpSolver->setObjective(m_obj.data());
+
+   if (warmStart)
+      m_lpSolver->resolve();
+   else
+      m_lpSolver->initialSolve();
+   if (!m_lpSolver->isProvenOptimal()) {
+      cout << "Failed to solve relaxation for pricing #" << m_depotId << ".\n";
+      writeLp("problematic.lp");
+      cout << "Problematic model written to problematic.lp.\n";
+      abort();
+   }
 
-      // Then update the deadheading arcs.
-      for (int j = 0; j < m_inst->numTrips(); ++j) {
-         if (int colId = m_x[i][j]; colId != -1) {
-            auto cost = m_inst->deadheadCost(i, j) - m_master->getTripDual(i);
-            m_lpSolver->setObjCoeff(colId, cost);
+   // The constraint matrix is a network matrix, so the optimal basic solution is
+   // integer and the branch-and-bound is seldom needed.
+   const auto lpSol = m_lpSolver->getColSolution();
+   m_solution.assign(lpSol, lpSol + m_colArc.size());
+   m_objValue = m_lpSolver->getObjValue();
+   #ifndef MIP_PRICING_LP
+      const bool integral = all_of(m_solution.begin(), m_solution.end(), [](double x) {
+         return fabs(x - round(x)) <= 1e-6;
+      });
+      if (!integral) {
+         if (!m_model) {
+            m_model.reset(new CbcModel(*m_lpSolver));
+            m_model->setLogLevel(0);
+            m_model->setNumberThreads(1);
+         } else {
+            // The solver of the model is a copy of the LP, so it takes the new objective,
+            // the bounds of the removed arcs, and the last basis.
+            auto mipSolver = m_model->solver();
+            mipSolver->setObjective(m_obj.data());
+            const auto colLower = m_lpSolver->getColLower();
+            const auto colUpper = m_lpSolver->getColUpper();
+            for (size_t col = 0; col < m_colArc.size(); ++col)
+               mipSolver->setColBounds(col, colLower[col], colUpper[col]);
+            unique_ptr<CoinWarmStart> basis(m_lpSolver->getWarmStart());
+            mipSolver->setWarmStart(basis.get());
+
+            // The cutoff and the best solution of the previous objective no longer apply.
+            m_model->resetModel();
+            m_model->setCutoff(numeric_limits<double>::max());
          }
+         if (!m_incumbent.empty()) {
+            double incumbentCost = 0.0;
+            for (size_t col = 0; col < m_incumbent.size(); ++col)
+               incumbentCost += m_obj[col] * m_incumbent[col];
+            m_model->setBestSolution(m_incumbent.data(), m_incumbent.size(), incumbentCost, true);
+         }
+         m_model->branchAndBound();
+         const auto mipSol = m_model->bestSolution();
+         if (mipSol == nullptr) {
+            cout << "Failed to solve integer pricing #" << m_depotId << ".\n";
+            writeLp("problematic.lp");
+            cout << "Problematic model written to problematic.lp.\n";
+            abort();
+         }
+         m_solution.assign(mipSol, mipSol + m_colArc.size());
+         m_objValue = m_model->getObjValue();
       }
+      m_incumbent = m_solution;
+   #endif
 
-      // And also the sink arcs.
-      if (int colId = m_x[i][D]; colId != -1) {
-         auto cost = m_inst->sinkCost(m_depotId, i) - m_master->getTripDual(i);
-         m_lpSolver->setObjCoeff(colId, cost);
-      }
-   }
-
-   m_model.reset(new CbcModel(*m_lpSolver));
-   
-   m_lpSolver->setLogLevel(0);
-   m_model->setLogLevel(0);
-   m_model->setNumberThreads(1);
-   
-   m_model->branchAndBound();
-   return m_model->getObjValue();
+   return m_objValue;
 }
 
 auto PricingCbc::getObjValue() const noexcept -> double {
-   return m_model->getObjValue();
+   return m_objValue;
 }
 
 auto PricingCbc::generateColumns() const noexcept -> int {
    vector<vector<int>> allPaths;
-   const auto sol = m_model->getColSolution();
-
-   // I think the algorithm can be accelerated by skipping the calculation
-   // of reduced cost per path.
 
    for (int i = 0; i < m_inst->numTrips(); ++i) {
-      if (auto col = m_x[sourceNode()][i]; col != -1 && sol[col] >= 0.98) {
+      if (auto col = m_sourceCol[i]; col != -1 && m_solution[col] >= 0.98) {
          vector<int> path = {i};
-         double pcost = m_inst->sourceCost(m_depotId, i) - m_master->getDepotCapDual(m_depotId);
-
-         findPathRecursive(path, pcost, allPaths);
+         findPathRecursive(path, m_obj[col], allPaths);
       }
    }
 
@@ -98,23 +138,21 @@ auto PricingCbc::generateColumns() const noexcept -> int {
    }
 
    return allPaths.size();
-   return 0.0;
 }
 
+// The objective of each column is the reduced cost of its arc, so the reduced cost
+// of a path is the sum of the objective over its columns.
 auto PricingCbc::findPathRecursive(std::vector<int> &path, double pcost, std::vector<std::vector<int>> &allPaths) const noexcept -> void {
-   const auto sol = m_model->getColSolution();  // hope this call to not be expensive...
-   if (auto col = m_x[path.back()][sinkNode()]; col != -1 && sol[col] >= 0.98) {
-      double cst = pcost + (m_inst->sinkCost(m_depotId, path.back()) - m_master->getTripDual(path.back()));
-      if (cst <= -0.001) {
+   if (auto col = m_sinkCol[path.back()]; col != -1 && m_solution[col] >= 0.98) {
+      if (pcost + m_obj[col] <= -0.001) {
          allPaths.push_back(path);
       }
    }
 
-   for (const auto &p : m_inst->deadheadSuccAdj(path.back())) {
-      if (auto col = m_x[path.back()][p.first]; col != -1 && sol[col] >= 0.98) {
-         double cst = pcost + (p.second - m_master->getTripDual(path.back()));
-         path.push_back(p.first);
-         findPathRecursive(path, cst, allPaths);
+   for (const auto &[j, col]: m_deadheadCols[path.back()]) {
+      if (m_solution[col] >= 0.98) {
+         path.push_back(j);
+         findPathRecursive(path, pcost + m_obj[col], allPaths);
          path.pop_back();
       }
    }
@@ -124,88 +162,77 @@ auto PricingCbc::buildModel() noexcept -> void {
    char buf[128];
    m_lpSolver.reset(new OsiClpSolverInterface());
 
-   // Create the variables.
-   const auto N = numNodes();
+   // Creates the variables, one per arc of the sparse adjacency, and collects the flow
+   // conservation rows along the way.
+   const auto numTrips = m_inst->numTrips();
    const auto O = sourceNode();
    const auto D = sinkNode();
-   m_x.resize(boost::extents[N][N]);
-   fill_n(m_x.data(), m_x.num_elements(), -1);
+   m_sourceCol.assign(numTrips, -1);
+   m_sinkCol.assign(numTrips, -1);
+   m_deadheadCols.assign(numTrips, {});
+   m_colArc.clear();
+   vector<vector<int>> rowCols(numTrips);
+   vector<vector<double>> rowCoefs(numTrips);
 
    // Class used to build models.
    CoinModel builder;
-
-   for (int i = 0; i < m_inst->numTrips(); ++i) {
+   auto addArc = [&](int i, int j, double cost) {
+      const int colId = builder.numberColumns();
+      m_colArc.emplace_back(i, j);
+      if (i != O) {
+         rowCols[i].push_back(colId);
+         rowCoefs[i].push_back(-1.0);
+      }
+      if (j != D) {
+         rowCols[j].push_back(colId);
+         rowCoefs[j].push_back(1.0);
+      }
+      #ifndef MIP_PRICING_LP
+         builder.addColumn(0, nullptr, nullptr, 0.0, 1.0, cost, buf, true);
+      #else
+         builder.addColumn(0, nullptr, nullptr, 0.0, 1.0, cost, buf, false);
+      #endif
+      return colId;
+   };
+
+   for (int i = 0; i < numTrips; ++i) {
       // Creates source arcs.
       if (auto cost = m_inst->sourceCost(m_depotId, i); cost != -1) {
          snprintf(buf, sizeof buf, "source#%d#%d", m_depotId, i);
-         m_x[O][i] = builder.numberColumns();
-         #ifndef MIP_PRICING_LP
-            builder.addColumn(0, nullptr, nullptr, 0.0, 1.0, cost, buf, true);
-         #else
-            builder.addColumn(0, nullptr, nullptr, 0.0, 1.0, cost, buf, false);
-         #endif
+         m_sourceCol[i] = addArc(O, i, cost);
       }
 
       // Creates sink arcs.
       if (auto cost = m_inst->sinkCost(m_depotId, i); cost != -1) {
          snprintf(buf, sizeof buf, "sink#%d#%d", m_depotId, i);
-         m_x[i][D] = builder.numberColumns();
-         #ifndef MIP_PRICING_LP
-            builder.addColumn(0, nullptr, nullptr, 0.0, 1.0, cost, buf, true);
-         #else
-            builder.addColumn(0, nullptr, nullptr, 0.0, 1.0, cost, buf, false);
-         #endif
+         m_sinkCol[i] = addArc(i, D, cost);
       }
 
       // Adds all deadheading arcs, or up to the maximum number of arcs allowed to expand.
       int numExpansions = m_maxLabelExpansions;
-      for (int j = 0; j < m_inst->numTrips(); ++j) {
-         if (auto cost = m_inst->deadheadCost(i, j); cost != -1) {
-            snprintf(buf, sizeof buf, "deadhead#%d#%d", i, j);
-            m_x[i][j] = builder.numberColumns();
-            #ifndef MIP_PRICING_LP
-               builder.addColumn(0, nullptr, nullptr, 0.0, 1.0, cost, buf, true);
-            #else
-               builder.addColumn(0, nullptr, nullptr, 0.0, 1.0, cost, buf, false);
-            #endif
-
-            if (--numExpansions == 0)
-               break;
-         }
+      for (auto &[j, cost]: deadheadSuccAdj(i)) {
+         snprintf(buf, sizeof buf, "deadhead#%d#%d", i, j);
+         m_deadheadCols[i].emplace_back(j, addArc(i, j, cost));
+
+         if (--numExpansions == 0)
+            break;
       }
    }
   
    // Adds the flow conservation constraints.
-   for (int i = 0; i < m_inst->numTrips(); ++i) {
-      vector<int> cols;
-      vector<double> coefs;
-
-      for (int j = 0; j < N; ++j) {
-         if (auto colId = m_x[i][j]; colId != -1) {
-            cols.push_back(colId);
-            coefs.push_back(-1.0);
-         }
-         if (auto colId = m_x[j][i]; colId != -1) {
-            cols.push_back(colId);
-            coefs.push_back(1.0);
-         }
-      }
-
+   for (int i = 0; i < numTrips; ++i) {
       snprintf(buf, sizeof buf, "flow_consevation#%d", i);
-      builder.addRow(cols.size(), cols.data(), coefs.data(), 0.0, 0.0, buf);
+      builder.addRow(rowCols[i].size(), rowCols[i].data(), rowCoefs[i].data(), 0.0, 0.0, buf);
    }
 
    // Optional constraint to force a single path.
    if (m_maxPaths >= 1) {
       vector<int> cols;
-      vector<double> coefs;
-
-      for (int i = 0; i < m_inst->numTrips(); ++i) {
-         if (auto colId = m_x[O][i]; colId != -1) {
+      for (int i = 0; i < numTrips; ++i) {
+         if (auto colId = m_sourceCol[i]; colId != -1)
             cols.push_back(colId);
-            coefs.push_back(1.0);
-         }
       }
+      vector<double> coefs(cols.size(), 1.0);
 
       snprintf(buf, sizeof buf, "max_paths#%d", m_depotId);
       builder.addRow(cols.size(), cols.data(), coefs.data(), -numeric_limits<double>::infinity(), m_maxPaths, buf);
@@ -217,4 +244,28 @@ auto PricingCbc::buildModel() noexcept -> void {
 
    m_lpSolver->loadFromCoinModel(builder);
    m_lpSolver->setObjName("shortest_path");
+   m_lpSolver->setLogLevel(0);
+   m_obj.resize(m_colArc.size());
+
+   // Only the objective changes between calls, which keeps the last basis primal
+   // feasible.
+   m_lpSolver->setHintParam(OsiDoDualInResolve, false, OsiHintDo);
 }
+
+auto PricingCbc::onArcsRemoved(const std::vector<std::pair<int, int>> &arcs) noexcept -> void {
+   // Models are only built in the first call to solve.
+   if (!m_lpSolver)
+      return;
+   for (auto &[i, j]: arcs) {
+      auto &cols = m_deadheadCols[i];
+      auto it = find_if(cols.begin(), cols.end(), [j = j](const pair<int, int> &arc) {
+         return arc.first == j;
+      });
+      if (it == cols.end())
+         continue;
+      const int colId = it->second;
+      m_lpSolver->setColUpper(colId, 0.0);
+      if (!m_incumbent.empty() && m_incumbent[colId] > 0.5)
+         m_incumbent.clear();
+   }
+}
\ No newline at end of file
@@ -2,9 +2,9 @@
 
 #include "CgPricingBase.h"
 
-#include <boost/multi_array.hpp>
 #include <coin/CbcModel.hpp>
 #include <coin/Cbc_C_Interface.h>
+#include <memory>
 
 class PricingCbc: public CgPricingBase {
 public:
@@ -21,13 +21,34 @@ public:
    virtual auto generateColumns() const noexcept -> int override;
 
 private:
-   // Used to model the problem
+   // Used to model the problem. The LP keeps its basis between calls to solve, and
+   // only the objective changes, so each call restarts from the last optimal basis.
    std::unique_ptr<OsiClpSolverInterface> m_lpSolver;
-   boost::multi_array<int, 2> m_x;
 
-   // Used to solve the problem as integer programming.
-   std::unique_ptr<CbcModel> m_model;   
+   // Columns are indexed by arc. Per trip, the columns of its source and sink arcs
+   // (-1 if none), and the (successor, column) pairs of its deadhead arcs.
+   std::vector<int> m_sourceCol;
+   std::vector<int> m_sinkCol;
+   std::vector<std::vector<std::pair<int, int>>> m_deadheadCols;
+
+   // Arc (i, j) of each column, and buffer to push the objective at once.
+   std::vector<std::pair<int, int>> m_colArc;
+   std::vector<double> m_obj;
+
+   // Used to solve the problem as integer programming, only when the LP solution is
+   // fractional. Built on the first of these calls, and reset before each other one.
+   std::unique_ptr<CbcModel> m_model;
+
+   // Solution of the last call to solve, from the LP or from the branch-and-bound.
+   std::vector<double> m_solution;
+   double m_objValue{0.0};
+
+   // Last integer solution, offered as incumbent to the branch-and-bound.
+   std::vector<double> m_incumbent;
 
    auto findPathRecursive(std::vector<int> &path, double pcost, std::vector<std::vector<int>> &allPaths) const noexcept -> void;
    auto buildModel() noexcept -> void;
+
+protected:
+   virtual auto onArcsRemoved(const std::vector<std::pair<int, int>> &arcs) noexcept -> void override;
 };
@@ -2,6 +2,7 @@
 #include "Instance.h"
 #include "CgMasterBase.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 
@@ -31,27 +32,19 @@ auto PricingCplex::solve() noexcept -> double {
    if (!m_cplex.getImpl())
       buildModel();
 
-   const auto N = m_inst->numTrips() + 2;
-   const auto O = N - 2;
-   const auto D = N - 1;
+   const auto O = sourceNode();
+   const auto D = sinkNode();
 
    IloExpr expr{m_env};
-   for (int i = 0; i < m_inst->numTrips(); ++i) {
-      // Creates source arcs.
-      if (auto cost = m_inst->sourceCost(m_depotId, i); cost != -1) {
-         expr += (cost - m_master->getDepotCapDual(m_depotId)) * m_x[O][i];
-      }
-
-      // Creates sink arcs.
-      if (auto cost = m_inst->sinkCost(m_depotId, i); cost != -1) {
-         expr += (cost - m_master->getTripDual(i)) * m_x[i][D];
-      }
-
-      // Adds all deadheading arcs.
-      for (auto &p: m_inst->deadheadSuccAdj(i)) {
-         if (m_x[i][p.first].getImpl())
-            expr += (p.second - m_master->getTripDual(i)) * m_x[i][p.first];
-      }
+   for (size_t col = 0; col < m_colArc.size(); ++col) {
+      const auto [i, j] = m_colArc[col];
+      if (i == O)
+         m_arcCost[col] = m_inst->sourceCost(m_depotId, j) - m_master->getDepotCapDual(m_depotId);
+      else if (j == D)
+         m_arcCost[col] = m_inst->sinkCost(m_depotId, i) - m_master->getTripDual(i);
+      else
+         m_arcCost[col] = m_inst->deadheadCost(i, j) - m_master->getTripDual(i);
+      expr += m_arcCost[col] * m_arcs[col];
    }
 
    m_obj.end();
@@ -70,15 +63,10 @@ auto PricingCplex::getObjValue() const noexcept -> double {
 auto PricingCplex::generateColumns() const noexcept -> int {
    vector<vector<int>> allPaths;
 
-   // I think the algorithm can be accelerated by skipping the calculation 
-   // of reduced cost per path. 
-
    for (int i = 0; i < m_inst->numTrips(); ++i) {
-      if (auto col = m_x[sourceNode()][i]; col.getImpl() && m_cplex.getValue(col) >= 0.98) {
+      if (auto col = m_sourceCol[i]; col != -1 && m_cplex.getValue(m_arcs[col]) >= 0.98) {
          vector<int> path = {i};
-         double pcost = m_inst->sourceCost(m_depotId, i) - m_master->getDepotCapDual(m_depotId);
-
-         findPathRecursive(path, pcost, allPaths);
+         findPathRecursive(path, m_arcCost[col], allPaths);
       }
    }
 
@@ -94,18 +82,16 @@ auto PricingCplex::generateColumns() const noexcept -> int {
 }
 
 auto PricingCplex::findPathRecursive(std::vector<int> &path, double pcost, std::vector<std::vector<int>> &allPaths) const noexcept -> void {
-   if (auto col = m_x[path.back()][sinkNode()]; col.getImpl() && m_cplex.getValue(col) >= 0.98) {
-      double cst = pcost + (m_inst->sinkCost(m_depotId, path.back()) - m_master->getTripDual(path.back()));
-      if (cst <= -0.001) {
+   if (auto col = m_sinkCol[path.back()]; col != -1 && m_cplex.getValue(m_arcs[col]) >= 0.98) {
+      if (pcost + m_arcCost[col] <= -0.001) {
          allPaths.push_back(path);
       }
    }
 
-   for (const auto &p: m_inst->deadheadSuccAdj(path.back())) {
-      if (auto col = m_x[path.back()][p.first]; col.getImpl() && m_cplex.getValue(col) >= 0.98) {
-         double cst = pcost + (p.second - m_master->getTripDual(path.back()));
-         path.push_back(p.first);
-         findPathRecursive(path, cst, allPaths);
+   for (const auto &[j, col]: m_deadheadCols[path.back()]) {
+      if (m_cplex.getValue(m_arcs[col]) >= 0.98) {
+         path.push_back(j);
+         findPathRecursive(path, pcost + m_arcCost[col], allPaths);
          path.pop_back();
       }
    }
@@ -113,7 +99,7 @@ auto PricingCplex::findPathRecursive(std::vector<int> &path, double pcost, std::
 
 auto PricingCplex::buildModel() noexcept -> void {
    char buf[128];
-   const auto N = numNodes();
+   const auto numTrips = m_inst->numTrips();
    const auto O = sourceNode();
    const auto D = sinkNode();
 
@@ -121,78 +107,76 @@ auto PricingCplex::buildModel() noexcept -> void {
    m_model = IloModel(m_env, buf);
    m_cplex = IloCplex(m_model);
 
+   // Variables only exist for the arcs of the sparse adjacency, and the flow
+   // conservation rows are collected while creating them.
+   m_arcs = IloNumVarArray(m_env);
+   m_sourceCol.assign(numTrips, -1);
+   m_sinkCol.assign(numTrips, -1);
+   m_deadheadCols.assign(numTrips, {});
+   m_colArc.clear();
    IloExpr expr{m_env};
-   m_x = IloArray<IloNumVarArray>(m_env, N);
-   for (int i = 0; i < N; ++i)
-      m_x[i] = IloNumVarArray(m_env, N);
+   vector<IloExpr> flow;
+   for (int i = 0; i < numTrips; ++i)
+      flow.emplace_back(m_env);
 
    #ifndef MIP_PRICING_LP
       const auto VarTy = IloNumVar::Bool;
    #else 
       const auto VarTy = IloNumVar::Float;
    #endif
-   for (int i = 0; i < m_inst->numTrips(); ++i) {
+   auto addArc = [&](int i, int j, double cost) {
+      const int col = m_arcs.getSize();
+      m_arcs.add(IloNumVar(m_env, 0.0, 1.0, VarTy, buf));
+      m_colArc.emplace_back(i, j);
+      expr += cost * m_arcs[col];
+      if (i != O)
+         flow[i] -= m_arcs[col];
+      if (j != D)
+         flow[j] += m_arcs[col];
+      return col;
+   };
+   for (int i = 0; i < numTrips; ++i) {
       // Creates source arcs.
       if (auto cost = m_inst->sourceCost(m_depotId, i); cost != -1) {
          snprintf(buf, sizeof buf, "source#%d#%d", m_depotId, i);
-         m_x[O][i] = IloNumVar(m_env, 0.0, 1.0, VarTy, buf);
-         expr += cost * m_x[O][i];
+         m_sourceCol[i] = addArc(O, i, cost);
       }
 
       // Creates sink arcs.
       if (auto cost = m_inst->sinkCost(m_depotId, i); cost != -1) {
          snprintf(buf, sizeof buf, "sink#%d#%d", m_depotId, i);
-         m_x[i][D] = IloNumVar(m_env, 0.0, 1.0, VarTy, buf);
-         expr += cost * m_x[i][D];
+         m_sinkCol[i] = addArc(i, D, cost);
       }
 
       // Adds all deadheading arcs, or up to the maximum number of arcs allowed to expand.
       int numExpansions = m_maxLabelExpansions;
-      for (auto &p: m_inst->deadheadSuccAdj(i)) {
+      for (auto &p: deadheadSuccAdj(i)) {
          snprintf(buf, sizeof buf, "deadhead#%d#%d", i, p.first);
-         m_x[i][p.first] = IloNumVar(m_env, 0.0, 1.0, VarTy, buf);
-         expr += p.second * m_x[i][p.first];
+         m_deadheadCols[i].emplace_back(p.first, addArc(i, p.first, p.second));
 
          if (--numExpansions == 0)
                break;
       }
    }
+   m_arcCost.resize(m_colArc.size());
 
    m_obj = IloObjective(m_env, expr, IloObjective::Minimize, "shortest_path");
    expr.clear();
 
    // Adds the flow conservation constraints.
-   for (int i = 0; i < m_inst->numTrips(); ++i) {
-      if (auto col = m_x[O][i]; col.getImpl()) {
-         expr += col;
-      }
-
-      if (auto col = m_x[i][D]; col.getImpl()) {
-         expr -= col;
-      }
-
-      for (auto &p: m_inst->deadheadPredAdj(i)) {
-         if (m_x[p.first][i].getImpl())
-            expr += m_x[p.first][i];
-      }
-
-      for (auto &p: m_inst->deadheadSuccAdj(i)) {
-         if (m_x[i][p.first].getImpl())
-            expr -= m_x[i][p.first];
-      }
-
+   for (int i = 0; i < numTrips; ++i) {
       snprintf(buf, sizeof buf, "flow_consevation#%d", i);
-      IloConstraint c = expr == 0;
+      IloConstraint c = flow[i] == 0;
       c.setName(buf);
       m_model.add(c);
-      expr.clear();
+      flow[i].end();
    }
 
    // Optional constraint to force a single path.
    if (m_maxPaths >= 1) {
-      for (int i = 0; i < m_inst->numTrips(); ++i) {
-         if (auto col = m_x[O][i]; col.getImpl()) {
-            expr += col;
+      for (int i = 0; i < numTrips; ++i) {
+         if (auto col = m_sourceCol[i]; col != -1) {
+            expr += m_arcs[col];
          }
       }
 
@@ -210,3 +194,17 @@ auto PricingCplex::buildModel() noexcept -> void {
    m_cplex.setOut(m_env.getNullStream());
    m_cplex.setWarning(m_env.getNullStream());
 }
+
+auto PricingCplex::onArcsRemoved(const std::vector<std::pair<int, int>> &arcs) noexcept -> void {
+   // Models are only built in the first call to solve.
+   if (!m_cplex.getImpl())
+      return;
+   for (auto &[i, j]: arcs) {
+      auto &cols = m_deadheadCols[i];
+      auto it = find_if(cols.begin(), cols.end(), [j = j](const pair<int, int> &arc) {
+         return arc.first == j;
+      });
+      if (it != cols.end())
+         m_arcs[it->second].setUB(0.0);
+   }
+}
@@ -23,8 +23,21 @@ private:
    IloModel m_model;
    IloCplex m_cplex;
    IloObjective m_obj;
-   IloArray<IloNumVarArray> m_x;
+
+   // Variables are indexed by arc. Per trip, the columns of its source and sink arcs
+   // (-1 if none), and the (successor, column) pairs of its deadhead arcs.
+   IloNumVarArray m_arcs;
+   std::vector<int> m_sourceCol;
+   std::vector<int> m_sinkCol;
+   std::vector<std::vector<std::pair<int, int>>> m_deadheadCols;
+
+   // Arc (i, j) of each column, and its reduced cost in the last call to solve.
+   std::vector<std::pair<int, int>> m_colArc;
+   std::vector<double> m_arcCost;
 
    auto findPathRecursive(std::vector<int> &path, double pcost, std::vector<std::vector<int>> &allPaths) const noexcept -> void;
    auto buildModel() noexcept -> void;
+
+protected:
+   virtual auto onArcsRemoved(const std::vector<std::pair<int, int>> &arcs) noexcept -> void override;
 };
@@ -3,6 +3,7 @@
 #include "Instance.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #ifdef MIP_PRICING_LP
@@ -41,28 +42,18 @@ auto PricingGlpk::solve() noexcept -> double {
 
    glp_term_out(GLP_OFF);
 
-   for (int i = 0; i < m_inst->numTrips(); ++i) {
-      // First updates the source arcs with the duals relative to
-      // the depot capacity.
-      if (int colId = m_x[O][i]; colId != -1) {
-         auto cost = m_inst->sourceCost(m_depotId, i) - m_master->getDepotCapDual(m_depotId);
-         glp_set_obj_coef(m_model, colId, cost);
-      }
-
-      // Then update the deadheading arcs.
-      for (int j = 0; j < m_inst->numTrips(); ++j) {
-         if (int colId = m_x[i][j]; colId != -1) {
-            auto cost = m_inst->deadheadCost(i, j) - m_master->getTripDual(i);
-            glp_set_obj_coef(m_model, colId, cost);
-         }
-      }
-
-      // And also the sink arcs.
-      if (int colId = m_x[i][D]; colId != -1) {
-         auto cost = m_inst->sinkCost(m_depotId, i) - m_master->getTripDual(i);
-         glp_set_obj_coef(m_model, colId, cost);
-      }
+   // Computes the reduced cost of all arcs first, then pushes them to the model.
+   for (size_t col = 1; col < m_colArc.size(); ++col) {
+      const auto [i, j] = m_colArc[col];
+      if (i == O)
+         m_obj[col] = m_inst->sourceCost(m_depotId, j) - m_master->getDepotCapDual(m_depotId);
+      else if (j == D)
+         m_obj[col] = m_inst->sinkCost(m_depotId, i) - m_master->getTripDual(i);
+      else
+         m_obj[col] = m_inst->deadheadCost(i, j) - m_master->getTripDual(i);
    }
+   for (size_t col = 1; col < m_colArc.size(); ++col)
+      glp_set_obj_coef(m_model, col, m_obj[col]);
 
    glp_smcp parm;
    glp_init_smcp(&parm);
@@ -76,48 +67,64 @@ auto PricingGlpk::solve() noexcept -> double {
       abort();
    }
 
+   // The constraint matrix is a network matrix, so the optimal basic solution is
+   // integer and the branch-and-bound is seldom needed.
+   m_solution.resize(m_colArc.size());
+   for (size_t col = 1; col < m_colArc.size(); ++col)
+      m_solution[col] = glp_get_col_prim(m_model, col);
+   m_objValue = glp_get_obj_val(m_model);
+
    #ifndef MIP_PRICING_LP
-      glp_iocp mipParm;
-      glp_init_iocp(&mipParm);
-      mipParm.br_tech = GLP_BR_DTH;
-      mipParm.bt_tech = GLP_BT_BPH;
-      mipParm.pp_tech = GLP_PP_ROOT;
-      mipParm.mip_gap = 1e-8;
-      // mipParm.msg_lev = GLP_MSG_ALL;
-
-      if (glp_intopt(m_model, &mipParm) != 0) {
-         cout << "Failed to solve pricing #" << m_depotId << " as integer program.\n";
-         writeLp("problematicMip.lp");
-         cout << "Problematic model written to problematicMip.lp.\n";
-         abort();
+      const bool integral = all_of(m_solution.begin() + 1, m_solution.end(), [](double x) {
+         return fabs(x - round(x)) <= 1e-6;
+      });
+      if (!integral) {
+         glp_iocp mipParm;
+         glp_init_iocp(&mipParm);
+         mipParm.br_tech = GLP_BR_DTH;
+         mipParm.bt_tech = GLP_BT_BPH;
+         mipParm.pp_tech = GLP_PP_ROOT;
+         mipParm.mip_gap = 1e-8;
+         // mipParm.msg_lev = GLP_MSG_ALL;
+
+         // Offers the last integer solution as the first incumbent.
+         mipParm.cb_info = this;
+         mipParm.cb_func = [](glp_tree *tree, void *info) {
+            auto pricing = static_cast<PricingGlpk *>(info);
+            if (glp_ios_reason(tree) == GLP_IHEUR && !pricing->m_incumbent.empty()) {
+               glp_ios_heur_sol(tree, pricing->m_incumbent.data());
+               pricing->m_incumbent.clear();
+            }
+         };
+
+         if (glp_intopt(m_model, &mipParm) != 0) {
+            cout << "Failed to solve pricing #" << m_depotId << " as integer program.\n";
+            writeLp("problematicMip.lp");
+            cout << "Problematic model written to problematicMip.lp.\n";
+            abort();
+         }
+
+         for (size_t col = 1; col < m_colArc.size(); ++col)
+            m_solution[col] = glp_mip_col_val(m_model, col);
+         m_objValue = glp_mip_obj_val(m_model);
       }
-      
-      return glp_mip_obj_val(m_model);
-   #else
-      return glp_get_obj_val(m_model);
+      m_incumbent = m_solution;
    #endif
+
+   return m_objValue;
 }
 
 auto PricingGlpk::getObjValue() const noexcept -> double {
-   #ifdef MIP_PRICING_LP
-      return glp_get_obj_val(m_model);
-   #else
-      return glp_mip_obj_val(m_model);
-   #endif
+   return m_objValue;
 }
 
 auto PricingGlpk::generateColumns() const noexcept -> int {
    vector<vector<int>> allPaths;
 
-   // I think the algorithm can be accelerated by skipping the calculation
-   // of reduced cost per path.
-
    for (int i = 0; i < m_inst->numTrips(); ++i) {
-      if (auto col = m_x[sourceNode()][i]; col != -1 && colValue(col) >= 0.98) {
+      if (auto col = m_sourceCol[i]; col != -1 && colValue(col) >= 0.98) {
          vector<int> path = {i};
-         double pcost = m_inst->sourceCost(m_depotId, i) - m_master->getDepotCapDual(m_depotId);
-
-         findPathRecursive(path, pcost, allPaths);
+         findPathRecursive(path, m_obj[col], allPaths);
       }
    }
 
@@ -132,30 +139,26 @@ auto PricingGlpk::generateColumns() const noexcept -> int {
    return allPaths.size();
 }
 
+// The objective of each column is the reduced cost of its arc, so the reduced cost
+// of a path is the sum of the objective over its columns.
 auto PricingGlpk::findPathRecursive(std::vector<int> &path, double pcost, std::vector<std::vector<int>> &allPaths) const noexcept -> void {
-   if (auto col = m_x[path.back()][sinkNode()]; col != -1 && colValue(col) >= 0.98) {
-      double cst = pcost + (m_inst->sinkCost(m_depotId, path.back()) - m_master->getTripDual(path.back()));
-      if (cst <= -0.001) {
+   if (auto col = m_sinkCol[path.back()]; col != -1 && colValue(col) >= 0.98) {
+      if (pcost + m_obj[col] <= -0.001) {
          allPaths.push_back(path);
       }
    }
 
-   for (const auto &p : m_inst->deadheadSuccAdj(path.back())) {
-      if (auto col = m_x[path.back()][p.first]; col != -1 && colValue(col) >= 0.98) {
-         double cst = pcost + (p.second - m_master->getTripDual(path.back()));
-         path.push_back(p.first);
-         findPathRecursive(path, cst, allPaths);
+   for (const auto &[j, col]: m_deadheadCols[path.back()]) {
+      if (colValue(col) >= 0.98) {
+         path.push_back(j);
+         findPathRecursive(path, pcost + m_obj[col], allPaths);
          path.pop_back();
       }
    }
 }
 
 auto PricingGlpk::colValue(int j) const noexcept -> double {
-   #ifdef MIP_PRICING_LP
-      return glp_get_col_prim(m_model, j);
-   #else
-      return glp_mip_col_val(m_model, j);
-   #endif
+   return m_solution[j];
 }
 
 auto PricingGlpk::buildModel() noexcept -> void {
@@ -169,13 +172,19 @@ auto PricingGlpk::buildModel() noexcept -> void {
    glp_set_obj_name(m_model, "shortest_path");
 
    // In this implementation, we use the original IDs for trips
-   const auto N = numNodes();
+   const auto numTrips = m_inst->numTrips();
    const auto O = sourceNode();
    const auto D = sinkNode();
 
-   // Reserve memory for storing the variables.
-   m_x.resize(boost::extents[N][N]);
-   fill_n(m_x.data(), m_x.num_elements(), -1);
+   // Columns are indexed by arc, and only exist for the arcs of the sparse adjacency.
+   m_sourceCol.assign(numTrips, -1);
+   m_sinkCol.assign(numTrips, -1);
+   m_deadheadCols.assign(numTrips, {});
+   m_colArc.assign(1, {-1, -1});
+
+   // Structures to fill rows of the problem, collected while creating the variables.
+   vector<vector<int>> rowCols(numTrips, vector<int>{0});
+   vector<vector<double>> rowCoefs(numTrips, vector<double>{0.0});
 
    // Creates all variables.
    auto addVar = [&](int i, int j, double cost) {
@@ -188,85 +197,79 @@ auto PricingGlpk::buildModel() noexcept -> void {
       #endif
       glp_set_col_bnds(m_model, colId, GLP_DB, 0.0, 1.0);
       glp_set_obj_coef(m_model, colId, cost);
-      m_x[i][j] = colId;
+      m_colArc.emplace_back(i, j);
+      if (i != O) {
+         rowCols[i].push_back(colId);
+         rowCoefs[i].push_back(-1.0);
+      }
+      if (j != D) {
+         rowCols[j].push_back(colId);
+         rowCoefs[j].push_back(1.0);
+      }
+      return colId;
    };
-   for (int i = 0; i < m_inst->numTrips(); ++i) {
+   for (int i = 0; i < numTrips; ++i) {
       if (auto cost = m_inst->sourceCost(m_depotId, i); cost != -1) {
          snprintf(buf, sizeof buf, "source#%d#%d", m_depotId, i);
-         addVar(O, i, cost);
+         m_sourceCol[i] = addVar(O, i, cost);
       }
       if (auto cost = m_inst->sinkCost(m_depotId, i); cost != -1) {
          snprintf(buf, sizeof buf, "sink#%d#%d", m_depotId, i);
-         addVar(i, D, cost);
+         m_sinkCol[i] = addVar(i, D, cost);
       }
       int numExpansions = m_maxLabelExpansions;
-      for (int j = 0; j < m_inst->numTrips(); ++j) {
-         if (auto cost = m_inst->deadheadCost(i, j); cost != -1) {
-            snprintf(buf, sizeof buf, "deadhead#%d#%d", i, j);
-            addVar(i, j, cost);
+      for (auto &[j, cost]: deadheadSuccAdj(i)) {
+         snprintf(buf, sizeof buf, "deadhead#%d#%d", i, j);
+         m_deadheadCols[i].emplace_back(j, addVar(i, j, cost));
 
-            if (--numExpansions == 0)
-               break;
-         }
+         if (--numExpansions == 0)
+            break;
       }
    }
 
-   // Structures to fill rows of the problem.
-   vector <int> matCols {0};
-   vector <double> matCoefs {0.0};
-
    // The model consists of a flow conservation solely.
-   int rowId = glp_add_rows(m_model, m_inst->numTrips());
-   for (int i = 0; i < m_inst->numTrips(); ++i, ++rowId) {
+   int rowId = glp_add_rows(m_model, numTrips);
+   for (int i = 0; i < numTrips; ++i, ++rowId) {
       snprintf(buf, sizeof buf, "flow_conservation#%d", i);
       glp_set_row_name(m_model, rowId, buf);
       glp_set_row_bnds(m_model, rowId, GLP_FX, 0.0, 0.0);
-
-      // Checks if there is source arc.
-      if (int colId = m_x[O][i]; colId != -1) {
-         matCols.push_back(colId);
-         matCoefs.push_back(1.0);
-      }
-
-      // Checks if there is sink arc.
-      if (int colId = m_x[i][D]; colId != -1) {
-         matCols.push_back(colId);
-         matCoefs.push_back(-1.0);
-      }
-
-      // Adds the remainder arcs.
-      for (int j = 0; j < m_inst->numTrips(); ++j) {
-         if (int colId = m_x[i][j]; colId != -1) {
-            matCols.push_back(colId);
-            matCoefs.push_back(-1.0);
-         }
-         if (int colId = m_x[j][i]; colId != -1) {
-            matCols.push_back(colId);
-            matCoefs.push_back(1.0);
-         }
-      }
-
-      glp_set_mat_row(m_model, rowId, matCols.size()-1, matCols.data(), matCoefs.data());
-      matCols.resize(1);
-      matCoefs.resize(1);
+      glp_set_mat_row(m_model, rowId, rowCols[i].size() - 1, rowCols[i].data(), rowCoefs[i].data());
    }
 
    // Single path per solve call.
    if (m_maxPaths >= 1) {
-      for (int i = 0; i < m_inst->numTrips(); ++i) {
+      vector <int> matCols {0};
+      for (int i = 0; i < numTrips; ++i) {
          // Checks if there is source arc.
-         if (int colId = m_x[O][i]; colId != -1) {
+         if (int colId = m_sourceCol[i]; colId != -1)
             matCols.push_back(colId);
-            matCoefs.push_back(1.0);
-         }
       }
-      int rowId = glp_add_rows(m_model, m_maxPaths);
+      vector <double> matCoefs(matCols.size(), 1.0);
+
+      int rowId = glp_add_rows(m_model, 1);
       snprintf(buf, sizeof buf, "max_paths");
       glp_set_row_name(m_model, rowId, buf);
       glp_set_row_bnds(m_model, rowId, GLP_UP, 0.0, m_maxPaths);
       
       glp_set_mat_row(m_model, rowId, matCols.size() - 1, matCols.data(), matCoefs.data());
-      matCols.resize(1);
-      matCoefs.resize(1);
+   }
+   m_obj.resize(m_colArc.size());
+}
+
+auto PricingGlpk::onArcsRemoved(const std::vector<std::pair<int, int>> &arcs) noexcept -> void {
+   // Models are only built in the first call to solve.
+   if (!m_model)
+      return;
+   for (auto &[i, j]: arcs) {
+      auto &cols = m_deadheadCols[i];
+      auto it = find_if(cols.begin(), cols.end(), [j = j](const pair<int, int> &arc) {
+         return arc.first == j;
+      });
+      if (it == cols.end())
+         continue;
+      const int colId = it->second;
+      glp_set_col_bnds(m_model, colId, GLP_FX, 0.0, 0.0);
+      if (!m_incumbent.empty() && m_incumbent[colId] > 0.5)
+         m_incumbent.clear();
    }
 }
@@ -2,7 +2,6 @@
 
 #include "CgPricingBase.h"
 
-#include <boost/multi_array.hpp>
 #include <glpk.h>
 
 class PricingGlpk: public CgPricingBase {
@@ -20,11 +19,33 @@ public:
    virtual auto generateColumns() const noexcept -> int override;
 
 private:
+   // The model keeps its basis between calls to solve, and only the objective changes,
+   // so each call restarts the simplex from the last optimal basis.
    glp_prob *m_model;
-   boost::multi_array<int, 2> m_x;
+
+   // Columns are indexed by arc. Per trip, the columns of its source and sink arcs
+   // (-1 if none), and the (successor, column) pairs of its deadhead arcs.
+   std::vector<int> m_sourceCol;
+   std::vector<int> m_sinkCol;
+   std::vector<std::vector<std::pair<int, int>>> m_deadheadCols;
+
+   // Arc (i, j) of each column, and buffer with the objective of all columns. Both are
+   // indexed from 1, as the columns of GLPK.
+   std::vector<std::pair<int, int>> m_colArc;
+   std::vector<double> m_obj;
+
+   // Solution of the last call to solve, from the LP or from the branch-and-bound.
+   std::vector<double> m_solution;
+   double m_objValue{0.0};
+
+   // Last integer solution, offered as incumbent to the branch-and-bound.
+   std::vector<double> m_incumbent;
 
    auto findPathRecursive(std::vector<int> &path, double pcost, std::vector<std::vector<int>> &allPaths) const noexcept -> void;
 
    auto colValue(int j) const noexcept -> double;
    auto buildModel() noexcept -> void;
+
+protected:
+   virtual auto onArcsRemoved(const std::vector<std::pair<int, int>> &arcs) noexcept -> void override;
 };
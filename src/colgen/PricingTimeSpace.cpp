@@ -0,0 +1,151 @@
+#include "PricingTimeSpace.h"
+#include "CgMasterBase.h"
+#include "Instance.h"
+#include "TimeSpaceNetwork.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+using namespace std;
+
+PricingTimeSpace::PricingTimeSpace(const Instance &inst, CgMasterBase &master, int depotId, const TimeSpaceNetwork &network, bool singlePath):
+CgPricingBase(inst, master, depotId, singlePath ? 1: 999999), m_network(&network) {
+
+   m_dist.resize(m_network->numNodes());
+   m_pred.resize(m_network->numNodes());
+   m_bestDist = numeric_limits<double>::infinity();
+   m_bestTrip = -1;
+}
+
+PricingTimeSpace::~PricingTimeSpace() {
+   // Empty
+}
+
+auto PricingTimeSpace::getSolverName() const noexcept -> std::string {
+   return "Shortest path over aggregated time-space network";
+}
+
+auto PricingTimeSpace::writeLp(const char *fname) const noexcept -> void {
+   (void) fname;
+   cout << "WARNING: Time-space pricing does not support writing LP files. Command ignored\n";
+}
+
+// The shortest paths use the costs of the network, and ignore the arcs removed from
+// the view of the depot and the trip chains. Paths failing the actual arcs are dropped
+// in generateColumns, so the objective value is not a valid bound.
+auto PricingTimeSpace::isExact() const noexcept -> bool {
+   return false;
+}
+
+auto PricingTimeSpace::solve() noexcept -> double {
+   fill(m_dist.begin(), m_dist.end(), numeric_limits<double>::infinity());
+   fill(m_pred.begin(), m_pred.end(), -1);
+   m_bestDist = numeric_limits<double>::infinity();
+   m_bestTrip = -1;
+
+   // Source arcs lead directly to the arrival node of the first trip, already
+   // accounting the dual of the trip.
+   const auto depotDual = m_master->getDepotCapDual(m_depotId);
+   for (int i = 0; i < m_inst->numTrips(); ++i) {
+      if (auto cost = m_inst->sourceCost(m_depotId, i); cost != -1) {
+         m_dist[m_network->arrivalNode(i)] = double(cost) - depotDual - m_master->getTripDual(i);
+      }
+   }
+
+   // The network is acyclic, so a single pass in topological order is enough.
+   for (int v: m_network->topologicalOrder()) {
+      if (m_dist[v] == numeric_limits<double>::infinity())
+         continue;
+
+      // The limit of label expansions applies to the deadhead arcs leaving the arrival
+      // nodes. Waiting and trip arcs are always evaluated, as they keep the lines connected.
+      int numExpansions = v < m_inst->numTrips() ? m_maxLabelExpansions : numeric_limits<int>::max();
+      for (auto &a: m_network->outArcs(v)) {
+         double len = a.cost;
+         if (a.trip != -1)
+            len -= m_master->getTripDual(a.trip);
+         if (m_dist[v] + len < m_dist[a.head]) {
+            m_dist[a.head] = m_dist[v] + len;
+            m_pred[a.head] = v;
+         }
+
+         if (--numExpansions == 0)
+            break;
+      }
+   }
+
+   for (int i = 0; i < m_inst->numTrips(); ++i) {
+      if (auto cost = m_inst->sinkCost(m_depotId, i); cost != -1) {
+         if (auto len = m_dist[m_network->arrivalNode(i)] + cost; len < m_bestDist) {
+            m_bestDist = len;
+            m_bestTrip = i;
+         }
+      }
+   }
+
+   return m_bestDist;
+}
+
+auto PricingTimeSpace::getObjValue() const noexcept -> double {
+   return m_bestDist;
+}
+
+auto PricingTimeSpace::generateColumns() const noexcept -> int {
+   vector<int> ends;
+   if (m_maxPaths == 1) {
+      if (m_bestTrip != -1)
+         ends.push_back(m_bestTrip);
+   } else {
+      for (int i = 0; i < m_inst->numTrips(); ++i) {
+         if (m_inst->sinkCost(m_depotId, i) != -1 && m_dist[m_network->arrivalNode(i)] != numeric_limits<double>::infinity())
+            ends.push_back(i);
+      }
+   }
+
+   int numCols = 0;
+   for (int last: ends) {
+      auto path = decodePath(last);
+
+      // The network represents the connections implicitly, so the paths are checked 
+      // against the deadhead arcs of the instance, and their reduced costs are 
+      // recomputed with the actual costs.
+      double rc = m_inst->sourceCost(m_depotId, path.front()) - m_master->getDepotCapDual(m_depotId);
+      bool valid = true;
+      for (size_t pos = 0; pos < path.size(); ++pos) {
+         const int trip = path[pos];
+         rc -= m_master->getTripDual(trip);
+         if (pos + 1 < path.size()) {
+            if (!hasDeadheadArc(trip, path[pos + 1])) {
+               valid = false;
+               break;
+            }
+            rc += m_inst->deadheadCost(trip, path[pos + 1]);
+         }
+      }
+      if (!valid)
+         continue;
+      rc += m_inst->sinkCost(m_depotId, path.back());
+
+      if (rc <= -0.001) {
+         m_master->beginColumn(m_depotId);
+         for (int trip: path)
+            m_master->addTrip(trip);
+         m_master->commitColumn();
+         ++numCols;
+      }
+   }
+
+   return numCols;
+}
+
+auto PricingTimeSpace::decodePath(int last) const noexcept -> std::vector<int> {
+   // Trips are the arrival nodes along the path, walking backwards.
+   vector<int> path;
+   for (int v = m_network->arrivalNode(last); v != -1; v = m_pred[v]) {
+      if (v < m_inst->numTrips())
+         path.push_back(v);
+   }
+   reverse(path.begin(), path.end());
+   return path;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CgPricingBase.h"
+
+class TimeSpaceNetwork;
+
+class PricingTimeSpace: public CgPricingBase {
+public:
+   PricingTimeSpace(const Instance &inst, CgMasterBase &master, int depotId, const TimeSpaceNetwork &network, bool singlePath = false);
+   virtual ~PricingTimeSpace();
+
+   virtual auto getSolverName() const noexcept -> std::string override;
+   virtual auto writeLp(const char *fname) const noexcept -> void override;
+
+   virtual auto isExact() const noexcept -> bool override;
+
+   virtual auto solve() noexcept -> double override;
+   virtual auto getObjValue() const noexcept -> double override;
+   virtual auto generateColumns() const noexcept -> int override;
+
+private:
+   const TimeSpaceNetwork *m_network;
+
+   // Labels over the nodes of the time-space network. The predecessor of a
+   // node is a node of the network, or -1 for arrival nodes reached from the source.
+   std::vector<double> m_dist;
+   std::vector<int> m_pred;
+
+   // Best sink arc.
+   double m_bestDist;
+   int m_bestTrip;
+
+   // Decodes the trips of the best path ending at trip `last`.
+   auto decodePath(int last) const noexcept -> std::vector<int>;
+};
@@ -0,0 +1,127 @@
+#include "TripChains.h"
+
+#include "Instance.h"
+
+#include <cassert>
+
+using namespace std;
+
+TripChains::TripChains(const Instance &inst, const std::vector<std::pair<int, int>> &required, bool detectForced): m_inst(&inst) {
+   const auto N = m_inst->numTrips();
+   const auto K = m_inst->numDepots();
+   m_next.assign(N, -1);
+   m_prev.assign(N, -1);
+
+   // Required arcs take precedence over the detected ones.
+   vector<char> isRequired(N, 0);
+   for (auto [i, j]: required) {
+      assert(m_next[i] == -1 && m_prev[j] == -1);
+      m_next[i] = j;
+      m_prev[j] = i;
+      isRequired[i] = 1;
+   }
+
+   auto hasSource = [&](int i) {
+      for (int k = 0; k < K; ++k) {
+         if (m_inst->sourceCost(k, i) != -1)
+            return true;
+      }
+      return false;
+   };
+
+   auto hasSink = [&](int i) {
+      for (int k = 0; k < K; ++k) {
+         if (m_inst->sinkCost(k, i) != -1)
+            return true;
+      }
+      return false;
+   };
+
+   // Collects the forced arcs. Two arcs sharing the same endpoint can only be
+   // forced in infeasible instances, so these conflicts are simply ignored.
+   vector<char> conflict(N, 0);
+   auto addForced = [&](int i, int j) {
+      if (m_next[i] == j)
+         return;
+      if ((m_next[i] != -1 && isRequired[i]) || (m_prev[j] != -1 && isRequired[m_prev[j]]))
+         return;
+      if (m_next[i] != -1 || m_prev[j] != -1) {
+         conflict[i] = conflict[j] = 1;
+         return;
+      }
+      m_next[i] = j;
+      m_prev[j] = i;
+   };
+
+   for (int i = 0; i < N && detectForced; ++i) {
+      const auto &succ = m_inst->deadheadSuccAdj(i);
+      if (succ.size() == 1 && !hasSink(i))
+         addForced(i, succ.front().first);
+
+      const auto &pred = m_inst->deadheadPredAdj(i);
+      if (pred.size() == 1 && !hasSource(i))
+         addForced(pred.front().first, i);
+   }
+
+   for (int i = 0; i < N; ++i) {
+      if (conflict[i] && m_next[i] != -1 && !isRequired[i]) {
+         m_prev[m_next[i]] = -1;
+         m_next[i] = -1;
+      }
+      if (conflict[i] && m_prev[i] != -1 && !isRequired[m_prev[i]]) {
+         m_next[m_prev[i]] = -1;
+         m_prev[i] = -1;
+      }
+   }
+
+   // Walks the chains from their heads. The deadheading network is acyclic,
+   // so every chain has a head.
+   m_tail.assign(N, -1);
+   m_cost.assign(N, 0);
+   for (int h = 0; h < N; ++h) {
+      if (m_prev[h] != -1)
+         continue;
+
+      int t = h;
+      while (m_next[t] != -1) {
+         m_cost[h] += m_inst->deadheadCost(t, m_next[t]);
+         t = m_next[t];
+         ++m_numContracted;
+      }
+      m_tail[h] = t;
+      if (t != h)
+         ++m_numChains;
+   }
+}
+
+TripChains::~TripChains() {
+   // Empty
+}
+
+auto TripChains::numChains() const noexcept -> int {
+   return m_numChains;
+}
+
+auto TripChains::numContractedTrips() const noexcept -> int {
+   return m_numContracted;
+}
+
+auto TripChains::isHead(int trip) const noexcept -> bool {
+   assert(trip >= 0 && trip < m_inst->numTrips());
+   return m_prev[trip] == -1;
+}
+
+auto TripChains::next(int trip) const noexcept -> int {
+   assert(trip >= 0 && trip < m_inst->numTrips());
+   return m_next[trip];
+}
+
+auto TripChains::tail(int head) const noexcept -> int {
+   assert(isHead(head));
+   return m_tail[head];
+}
+
+auto TripChains::internalCost(int head) const noexcept -> int {
+   assert(isHead(head));
+   return m_cost[head];
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+class Instance;
+
+/**
+ * @brief Contraction of forced trip sequences.
+ * 
+ * A deadhead arc (i,j) is forced when trip i has no sink arc and j is its
+ * single successor, or when trip j has no source arc and i is its single
+ * predecessor. In any feasible solution, a forced arc is always used, so 
+ * each maximal sequence of forced arcs (a chain) can be handled as a single
+ * node by the pricing algorithms: the chain is entered by its first trip 
+ * (head) and left by its last trip (tail.)
+ */
+class TripChains {
+public:
+   // Besides the forced arcs detected in the instance (when `detectForced` is set),
+   // the chains contain the `required` arcs, e.g., arcs fixed by branching. Required
+   // arcs can not share endpoints.
+   TripChains(const Instance &inst, const std::vector<std::pair<int, int>> &required = {}, bool detectForced = true);
+   virtual ~TripChains();
+
+   // Number of chains with at least two trips.
+   auto numChains() const noexcept -> int;
+
+   // Number of trips that are not heads of chains, i.e., nodes removed
+   // from the pricing graph.
+   auto numContractedTrips() const noexcept -> int;
+
+   // Queries the structure of the chains. Trips that are not part of any
+   // chain are heads (and tails) of chains of size one.
+   auto isHead(int trip) const noexcept -> bool;
+   auto next(int trip) const noexcept -> int;
+   auto tail(int head) const noexcept -> int;
+
+   // Sum of deadheading costs of the forced arcs of the chain.
+   auto internalCost(int head) const noexcept -> int;
+
+private:
+   const Instance *m_inst;
+   int m_numChains{0};
+   int m_numContracted{0};
+
+   // [trip] -> forced successor, or -1
+   std::vector<int> m_next;
+   // [trip] -> forced predecessor, or -1
+   std::vector<int> m_prev;
+
+   // [head] -> last trip of the chain and sum of internal costs.
+   std::vector<int> m_tail;
+   std::vector<int> m_cost;
+};
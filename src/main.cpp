@@ -3,27 +3,42 @@
 #include "ModelCbc.h"
 #include "Timer.h"
 #include "MemQuery.h"
+#include "ExportQueue.h"
 #include "colgen/CgMasterBase.h"
 #include "colgen/CgMasterGlpk.h"
 #include "colgen/CgMasterClp.h"
+#include "colgen/CgMasterNative.h"
 #include "colgen/PricingBellman.h"
 #include "colgen/PricingSpfa.h"
 #include "colgen/PricingCbc.h"
 #include "colgen/PricingGlpk.h"
+#include "colgen/PricingTimeSpace.h"
+#include "colgen/TripChains.h"
+#include "colgen/GreedyHeuristic.h"
+#include "colgen/PoolMip.h"
+#include "colgen/LocalSearch.h"
+#include "colgen/ColumnRecombination.h"
+#include "colgen/LagrangianMaster.h"
+#include "colgen/BranchAndPrice.h"
+#include "TimeSpaceNetwork.h"
 
 #ifdef HAVE_CPLEX
    #include "colgen/CgMasterCplex.h"
    #include "colgen/PricingCplex.h"
 #endif
 
-#include "glpk.h"
-
 #include <iostream>
 #include <string>
 #include <iomanip>
+#include <sstream>
 #include <random>
 #include <fstream>
 #include <csignal>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <numeric>
+#include <tuple>
 
 #include <boost/program_options.hpp>
 
@@ -33,6 +48,27 @@ using namespace std;
 
 using CmdParm = boost::program_options::variables_map;
 
+// Arc (depot, pred, succ) of the compact model. The source node is numTrips(), and
+// the sink node is numTrips()+1.
+using ReducedArc = tuple<int, int, int>;
+
+// Creates the pricing subproblem of a depot, attached to a given master problem.
+using PricingFactory = function<unique_ptr<CgPricingBase>(CgMasterBase &rmp, int depotId)>;
+
+// Settings of the truncated column generation, read once from the environment.
+struct TcgSettings {
+   int varSelection;
+   int graspStrategy;
+   double graspAlpha;
+   int maxSubIterations;
+   int rcFixingInterval;
+   double fixThreshold;
+   int fixTopK;
+   int maxBacktracks;
+   int backtrackDepth;
+   double backtrackThreshold;
+};
+
 // Signals if the program received a CTRL+C signal.
 volatile bool MdvspSigInt = false;
 
@@ -53,11 +89,45 @@ auto solveCompactModel(const CmdParm &parm, const Instance &inst) noexcept -> in
 // Solves a problem using column generation.
 auto solveColumnGeneration(const CmdParm &parm, const Instance &inst) noexcept -> int;
 
-// Create a compact reduced model using GLPK API.
-auto exportReducedModel(const Instance &inst, const CgMasterBase &rmp, const char outName[]) noexcept -> void;
+// Computes the lower bound of the Lagrangian relaxation of the trip assignment rows, without
+// a master problem.
+auto solveLagrangian(const CmdParm &parm, const Instance &inst) noexcept -> int;
+
+// Creates the factory of the pricing subproblems chosen by --pricing. The time-space network,
+// if the subproblems need one, is stored in `network`. `pathControl` tells if the subproblems
+// honor --max-paths, and `maxThreads` is lowered for solvers that are not thread safe. Returns
+// an empty factory when the parameters are invalid.
+auto createPricingFactory(const CmdParm &parm, const Instance &inst, unique_ptr<TimeSpaceNetwork> &network, bool &pathControl, int &maxThreads) noexcept -> PricingFactory;
+
+// Writes the reduced compact model, made of the arcs found by findReducedArcs(), as a LP file.
+auto exportReducedModel(const Instance &inst, const vector<ReducedArc> &arcs, const char outName[]) noexcept -> void;
+
+// Collects the arcs used by the columns of the RMP, sorted and without repetitions.
+auto findReducedArcs(const Instance &inst, const CgMasterBase &rmp, const vector<unique_ptr<CgPricingBase>> &pricing) noexcept -> vector<ReducedArc>;
+
+// Solves the reduced compact model in-process with CBC, starting from a known schedule.
+auto solveReducedModel(const Instance &inst, const CgMasterBase &rmp, const vector<unique_ptr<CgPricingBase>> &pricing, const vector<pair<int, vector<int>>> &schedule, double timeLimit) noexcept -> void;
 
 // Given a root node of CG, solves the truncated CG.
-auto solveTruncatedColumnGeneration(const Instance &inst, CgMasterBase &rmp, vector<unique_ptr<CgPricingBase>> &pricing) noexcept -> void ;
+// Returns the value of the best schedule found, whose vehicles are stored in `schedule`.
+// The final master problems are queued into `exports`.
+auto solveTruncatedColumnGeneration(const Instance &inst, CgMasterBase &rmp, vector<unique_ptr<CgPricingBase>> &pricing, const PricingFactory &makePricing, double upperBound, vector<pair<int, vector<int>>> &schedule, ExportQueue &exports) noexcept -> double;
+
+// Runs a single dive of the truncated CG, fixing columns of `rmp` until every trip is covered.
+// Dives are abandoned once their bound can not beat `incumbent`, the best value found by any
+// dive. Returns the cost of the schedule found, or infinity for incomplete or abandoned dives.
+auto graspDive(const Instance &inst, CgMasterBase &rmp, vector<unique_ptr<CgPricingBase>> &pricing, const TcgSettings &settings, double upperBound, unsigned seed, const atomic<double> &incumbent, bool verbose) noexcept -> double;
+
+// Removes the deadhead arcs that cannot improve the upper bound, given the current duals of the RMP.
+// Returns the number of arcs removed from the pricing subproblems.
+auto reducedCostFixing(const Instance &inst, double rmpObj, double upperBound, vector<unique_ptr<CgPricingBase>> &pricing) noexcept -> int;
+
+// Copies the set partitioning master problem for the export queue, and queues files written from it.
+auto snapshotMaster(const Instance &inst, const CgMasterBase &master) noexcept -> shared_ptr<CgMasterBase>;
+auto pushSnapshot(ExportQueue &exports, const string &fname, const shared_ptr<CgMasterBase> &snapshot, function<void(CgMasterBase &, const char *)> write, bool compressible = true) noexcept -> string;
+
+// Reads the mapping of trip ids between two versions of a timetable.
+auto readTripMap(const char *fname) noexcept -> vector<int>;
 
 auto main(int argc, char *argv[]) noexcept -> int {
    // Basic app initialization.
@@ -65,12 +135,16 @@ auto main(int argc, char *argv[]) noexcept -> int {
    signal(SIGINT, sigintHandler);
    
    // Parses the problem data.
-   Instance inst(parm["instance"].as<string>().c_str(), getEnvSortDeadheadArcs());
+   Timer tm;
+   tm.start();
+   Instance inst(parm["instance"].as<string>().c_str(), getEnvSortDeadheadArcs(), getEnvPreprocessDeadheadArcs());
 
    cout << "--- MDVSP solver ---\n" <<
       "Instance: " << inst.fileName() << "\n" <<
       "Number of depots: " << inst.numDepots() << "\n" <<
-      "Number of trips: " << inst.numTrips() << "\n\n";
+      "Number of trips: " << inst.numTrips() << "\n" <<
+      "Dominated deadhead arcs removed: " << inst.numDominatedArcs() << "\n" <<
+      "Load time: " << tm.elapsed() << " sec\n\n";
 
    // Decides if compact formulation should be used when solving the problem.
    const auto methodName = parm["method"].as<string>();
@@ -78,6 +152,8 @@ auto main(int argc, char *argv[]) noexcept -> int {
       return solveCompactModel(parm, inst);  
    } else if(methodName == "cg") {
       return solveColumnGeneration(parm, inst);
+   } else if (methodName == "lagrangian") {
+      return solveLagrangian(parm, inst);
    } else {
       cout << "Unknown solution method: " << methodName << ".\n";
       return EXIT_FAILURE;
@@ -95,7 +171,9 @@ auto parseCommandline(int argc, char **argv) noexcept -> CmdParm {
       ("instance,i", po::value<string>(), "path to the instance file")
 
       ("method", po::value<string>()->default_value("cg"), "defines the algorithm to be employed "
-      "for solving the problem. Accepted values: compact, cg")
+      "for solving the problem. Accepted values: compact, cg, lagrangian. The lagrangian method "
+      "only computes a lower bound, by subgradient over the Lagrangian relaxation of the trip "
+      "assignment rows, whose subproblems are the pricing subproblems.")
 
       ("master,m", po::value<string>()->default_value("glpk"), "defines the implementation "
       "backend to use while solving the restricted relaxed master problem. Only has effect when "
@@ -103,23 +181,71 @@ auto parseCommandline(int argc, char **argv) noexcept -> CmdParm {
       #ifdef HAVE_CPLEX
          "cplex, "
       #endif
-      "clp")
+      "clp, native")
+
+      ("race-master", "solves the restricted master problem by racing the primal simplex, the dual "
+       "simplex and the barrier in parallel threads, keeping the first to finish. Reports which "
+       "algorithm won in each phase. Requires the clp master.")
+
+      ("central-duals", "solves the restricted master problem by the barrier, without crossover, so "
+       "that the pricing gets well-centered duals instead of the ones of a vertex. The simplex only "
+       "certifies the optimum of the RMP once the pricing finds no column, and solves the masters of "
+       "the truncated column generation. Requires the clp or cplex master.")
 
       ("pricing,p", po::value<string>()->default_value("spfa"), "defines the implementation "
       "backend to use while solving the pricing subproblems. Only has effect when "
-      "the solution method is cg. Accepted values: spfa, bellman, glpk, cbc"
+      "the solution method is cg. Accepted values: spfa, bellman, timespace, glpk, cbc"
       #ifdef HAVE_CPLEX
          ", cplex"
       #endif
       )
 
+      ("timetable", po::value<string>(), "path to the timetable (trip times and locations) of the "
+       "instance. Required by the timespace pricing.")
+
       ("max-paths", po::value<int>()->default_value(1), "defines the maximum number of paths, "
        "per iteration, to extract from pricing subproblems. The exact number of paths is only "
        "available when solving with glpk, cbc, or cplex. When using spfa and bellman algorithms, "
        "generates as many paths as possible with no limitation. Only has effect when "
        "the solution method is cg.")
 
-      ("import-cols", po::value<string>(), "import columns stored in the text file 'arg'")
+      ("import-cols", po::value<string>(), "import columns stored in the file 'arg', either in text "
+       "or binary format. Binary files are only accepted for the instance they were exported from.")
+
+      ("warm-start", po::value<string>(), "import columns exported by a previous run on a modified "
+       "timetable. Columns using removed trips or connections are split or trimmed.")
+
+      ("trip-map", po::value<string>(), "text file with one 'old new' pair of trip ids per line, "
+       "used by --warm-start. Unlisted trips are considered removed. By default, trips keep their ids.")
+
+      ("lagrangian-warm-start", "before the column generation, runs the subgradient over the "
+       "Lagrangian relaxation of the trip assignment rows, and seeds the RMP with the paths of least "
+       "reduced cost at the best multipliers.")
+
+      ("upper-bound", po::value<double>(), "value of a known solution to the problem. When set, "
+       "enables the reduced-cost fixing of deadhead arcs during the column generation.")
+
+      ("solve-reduced", "after the truncated column generation, solves the reduced compact model "
+       "in-process with CBC, using all threads and the TCG solution as MIP start.")
+
+      ("reduced-time-limit", po::value<double>()->default_value(600.0), "time limit, in seconds, "
+       "of the solve of the reduced compact model.")
+
+      ("pool-mip", "runs a helper thread during the column generation, which periodically solves "
+       "the set partitioning MIP over the columns generated so far with CBC. Its solutions are used "
+       "as upper bound.")
+
+      ("compact-time-limit", po::value<double>()->default_value(3600.0), "time limit, in seconds, "
+       "of the solve of the compact model. Only has effect when the solution method is compact.")
+
+      ("branch-and-price", "after the truncated column generation, solves the problem to optimality "
+       "by branch-and-price. Requires spfa or bellman pricing.")
+
+      ("bp-time-limit", po::value<double>()->default_value(3600.0), "time limit, in seconds, of the "
+       "branch-and-price.")
+
+      ("bp-checkpoint", po::value<string>(), "file where the branch-and-price search is periodically "
+       "saved. When the file exists, the search is resumed from it.")
    ;
 
    po::variables_map vm;
@@ -135,7 +261,6 @@ auto parseCommandline(int argc, char **argv) noexcept -> CmdParm {
 }
 
 auto solveCompactModel(const CmdParm &parm, const Instance &inst) noexcept -> int {
-   (void) parm;
    unique_ptr <ModelCbc> compact;
    cout << "Solution method of choice: compact formulation (Coin-OR CBC)\n";
   
@@ -157,6 +282,20 @@ auto solveCompactModel(const CmdParm &parm, const Instance &inst) noexcept -> in
    cout << "Memory consumed by the model: " << memMB << " MB\n";
    cout << "Compact model written to 'compact.lp'.\n";
    cout << "Time spent writing file: " << writeTime << " sec.\n";
+   cout << "Compact model: " << compact->numColumns() << " columns, " << compact->numRows() << " rows" << endl;
+
+   // Solves the model with branch-and-cut, using all threads.
+   tm.start();
+   mem = getMemoryUsageKb();
+   const int numThreads = omp_get_max_threads();
+   const bool optimal = compact->solve(numThreads, parm["compact-time-limit"].as<double>());
+   cout << "\nCompact model solved with " << numThreads << " threads in " << tm.elapsed() << " sec, " <<
+      compact->getNodeCount() << " nodes\n";
+   cout << "Memory consumed by the solve: " << (getMemoryUsageKb()-mem)/1024.0 << " MB\n";
+   if (!optimal)
+      cout << "WARNING: Optimality of the compact model was not proven.\n";
+   cout << "Compact model solution: " << compact->getObjValue() << "\n";
+   cout << "Compact model bound: " << compact->getBestBound() << endl;
    
    return EXIT_SUCCESS; 
 }
@@ -184,6 +323,8 @@ auto solveColumnGeneration(const CmdParm &parm, const Instance &inst) noexcept -
 #endif
    else if (masterImpl == "clp") {
       master.reset(new CgMasterClp(inst));
+   } else if (masterImpl == "native") {
+      master.reset(new CgMasterNative(inst));
    } else {
       cout << "Unknown implementation for RMP solver: " << masterImpl << ".\n";
       return EXIT_FAILURE;
@@ -198,50 +339,38 @@ auto solveColumnGeneration(const CmdParm &parm, const Instance &inst) noexcept -
       cout << "Imported " << nc << " columns from " << parm["import-cols"].as<string>() << ".\n";
    }
 
-   // Parses the parameter of max-paths.
-   const int maxPaths = parm["max-paths"].as<int>();
-   if (maxPaths <= 0) {
-      cout << "Parameter --max-paths need to be >= 1.\n";
+   // Warm start from the columns of a previous run.
+   if (parm.count("warm-start") != 0) {
+      vector<int> tripMap;
+      if (parm.count("trip-map") != 0)
+         tripMap = readTripMap(parm["trip-map"].as<string>().c_str());
+      tm.start();
+      const auto ws = master->warmStartColumns(parm["warm-start"].as<string>().c_str(), tripMap);
+      cout << "Warm start: " << ws.loaded << " columns loaded from " << ws.read << " (" << 
+         ws.repaired << " repaired, " << ws.dropped << " dropped) in " << tm.elapsed() << " sec.\n";
+   }
+
+   // Branching decisions are enforced in the pricing graphs, through trip chains.
+   if (parm.count("branch-and-price") != 0 && parm["pricing"].as<string>() != "spfa" && 
+      parm["pricing"].as<string>() != "bellman") {
+      cout << "Branch-and-price requires spfa or bellman pricing.\n";
       return EXIT_FAILURE;
    }
 
    // Creates the pricing subproblems.
    int maxThreads = omp_get_max_threads(); 
-   const auto pricingImpl = parm["pricing"].as<string>();
+   const int maxPaths = parm["max-paths"].as<int>();
    tm.start();
    cout << "\nBuilding pricing subproblems.\n";
+
+   // The time-space network is shared by all subproblems.
+   unique_ptr<TimeSpaceNetwork> network;
    bool pricingPathControl = true;
+   const auto makePricing = createPricingFactory(parm, inst, network, pricingPathControl, maxThreads);
+   if (!makePricing)
+      return EXIT_FAILURE;
    for (int k = 0; k < inst.numDepots(); ++k) {
-      if (pricingImpl == "spfa") {
-         pricing.emplace_back(make_unique<PricingSpfa>(inst, *master, k, maxPaths == 1));
-         pricingPathControl = false;
-      } else if (pricingImpl == "bellman") {
-         pricing.emplace_back(make_unique<PricingBellman>(inst, *master, k, maxPaths == 1));
-         pricingPathControl = false;
-      } else if (pricingImpl == "glpk") {
-         pricing.emplace_back(make_unique<PricingGlpk>(inst, *master, k, maxPaths));
-         maxThreads = 1; // To circumvent problems with GLPK and multi-threading applications
-         #ifdef MIP_PRICING_LP
-            cout << "Solving pricing subproblems as LP.\n";
-         #endif
-      } else if (pricingImpl == "cbc") {
-         pricing.emplace_back(make_unique<PricingCbc>(inst, *master, k, maxPaths));
-         #ifdef MIP_PRICING_LP
-            cout << "Solving pricing subproblems as LP.\n";
-         #endif
-      } 
-   #ifdef HAVE_CPLEX
-      else if (pricingImpl == "cplex") {
-         pricing.emplace_back(make_unique<PricingCplex>(inst, *master, k, maxPaths));
-         #ifdef MIP_PRICING_LP
-            cout << "Solving pricing subproblems as LP.\n";
-         #endif
-      } 
-   #endif
-      else {
-         cout << "Unknown implementation for pricing solver: " << pricingImpl << ".\n";
-         return EXIT_FAILURE;
-      }
+      pricing.emplace_back(makePricing(*master, k));
    }
    tm.finish();
    cout << "Solver: " << pricing.front()->getSolverName() << "\n";
@@ -259,12 +388,132 @@ auto solveColumnGeneration(const CmdParm &parm, const Instance &inst) noexcept -
    for (auto &k: pricing) {
       k->setMaxLabelExpansionsPerNode(getEnvMaxLabelExpansions());
    }
+
+   // Optional contraction of forced trip sequences in the pricing graph.
+   unique_ptr<TripChains> chains;
+   if (getEnvContractTripChains()) {
+      chains.reset(new TripChains(inst));
+      cout << "Contracted " << chains->numContractedTrips() << " trips into " << chains->numChains() << " chains.\n";
+      master->setTripChains(chains.get());
+      for (auto &k: pricing) {
+         k->setTripChains(chains.get());
+      }
+   }
+
+   // Upper bound used by reduced-cost fixing of arcs.
+   double upperBound = numeric_limits<double>::infinity();
+   if (parm.count("upper-bound") != 0) {
+      upperBound = parm["upper-bound"].as<double>();
+      cout << "Using upper bound: " << upperBound << "\n";
+   }
+   const auto rcFixingInterval = getEnvRcFixingInterval();
+
+   // Seeds the RMP with the schedule of a constructive heuristic, so the 
+   // dummy columns are priced out from the first iteration.
+   const auto greedyStarts = getEnvGreedyStarts();
+   double timeGreedy = 0.0;
+   if (greedyStarts > 0) {
+      tm.start();
+      GreedyHeuristic heur(inst);
+      const bool feasible = heur.solve(greedyStarts);
+      const auto nc = heur.addColumns(*master);
+      timeGreedy = tm.elapsed();
+      cout << "\nGreedy heuristic: " << nc << " columns, " << 
+         (feasible ? "cost " + to_string(heur.getObjValue()) : string("partial schedule")) << 
+         ", " << timeGreedy << " sec\n";
+      if (feasible && heur.getObjValue() < upperBound) {
+         upperBound = heur.getObjValue();
+         cout << "Using upper bound: " << upperBound << "\n";
+      }
+   }
    
+   // The Lagrangian bound is only valid when the pricing subproblems are solved to optimality.
+   bool exactPricing = true;
+   for (auto &sp: pricing)
+      exactPricing = exactPricing && sp->isExact() && sp->maxLabelExpansionsPerNode() == numeric_limits<int>::max();
+
+   // Lagrangian relaxation of the trip assignment rows, over its own copies of the
+   // pricing subproblems. Its paths near the best multipliers seed the RMP.
+   if (parm.count("lagrangian-warm-start") != 0) {
+      cout << "\nStarting Lagrangian relaxation.\n";
+      tm.start();
+      LagrangianMaster lagrangian(inst);
+      lagrangian.setTripChains(chains.get());
+      vector<unique_ptr<CgPricingBase>> lagrangianPricing;
+      for (int k = 0; k < inst.numDepots(); ++k) {
+         lagrangianPricing.emplace_back(makePricing(lagrangian, k));
+         lagrangianPricing.back()->inheritFrom(*pricing[k]);
+      }
+      const auto bound = lagrangian.optimize(lagrangianPricing, getEnvLagrangianIterations(), upperBound, maxThreads);
+      cout << "Lagrangian bound: " << fixed << setprecision(2) << bound << " (" << lagrangian.numIterations() << 
+         " iterations, " << lagrangian.numColumns() << " paths, " << tm.elapsed() << " sec)\n";
+      if (!exactPricing)
+         cout << "WARNING: The pricing is not exact, so the bound may not be valid.\n";
+      if (upperBound < numeric_limits<double>::infinity())
+         cout << "Gap to the upper bound: " << (upperBound - bound) / upperBound * 100.0 << "%\n";
+      const auto nc = lagrangian.addColumnsTo(*master, inst.numTrips());
+      cout << "Seeded the RMP with " << nc << " columns of the Lagrangian relaxation.\n";
+   }
+
+   // Optional helper thread, solving the MIP over the columns generated so far.
+   unique_ptr<PoolMip> poolMip;
+   if (parm.count("pool-mip") != 0) {
+      poolMip.reset(new PoolMip(inst, getEnvPoolMipInterval(), getEnvPoolMipTimeLimit()));
+      poolMip->setCutoff(upperBound);
+      cout << "Pool MIP heuristic running in background.\n";
+   }
+
+   // Heuristic pricing by recombination of the columns in the RMP solution.
+   unique_ptr<ColumnRecombination> recombination;
+   if (const auto maxCols = getEnvRecombinationColumns(); maxCols > 0) {
+      recombination.reset(new ColumnRecombination(inst, maxCols));
+      recombination->setTripChains(chains.get());
+   }
+   int numRecombinations = 0;
+
+   // Racing master: number of wins of primal, dual and barrier, in the relaxed and in
+   // the set partitioning phases.
+   auto *racingMaster = parm.count("race-master") != 0 ? dynamic_cast<CgMasterClp *>(master.get()) : nullptr;
+   if (parm.count("race-master") != 0 && !racingMaster) {
+      cout << "The racing master requires the clp master.\n";
+      return EXIT_FAILURE;
+   }
+   int raceWins[2][3] = {};
+
+   // Central duals: the RMP is solved by the barrier until its duals price out no
+   // column, and then by the simplex, which certifies the optimum of the RMP.
+   const bool centralDuals = parm.count("central-duals") != 0;
+   if (centralDuals) {
+      bool hasBarrier = dynamic_cast<CgMasterClp *>(master.get()) != nullptr;
+#ifdef HAVE_CPLEX
+      if (auto *cplexMaster = dynamic_cast<CgMasterCplex *>(master.get())) {
+         cplexMaster->setBarrierGap(getEnvBarrierGap());
+         hasBarrier = true;
+      }
+#endif
+      if (!hasBarrier) {
+         cout << "The central duals require the clp or cplex master.\n";
+         return EXIT_FAILURE;
+      }
+      if (racingMaster) {
+         cout << "The central duals cannot be combined with the racing master.\n";
+         return EXIT_FAILURE;
+      }
+   }
+   bool certifying = false;
+   int numCertifications = 0;
+
    // Variables that store the progress of the optimization.
    bool masterRelax = true;
    double timeMaster = 0.0, timePricing = 0.0;
    double rmpObj = 0.0, lbObj = 0.0;
+   double lagrangianBound = -numeric_limits<double>::infinity();
    int newCols = 0;
+   // First iteration in which the RMP no longer relies on dummy columns, and the time
+   // of column generation spent up to it. Comparing them against a run with 
+   // GREEDY_STARTS=0 gives what the greedy seed saves.
+   int iterNoDummies = -1;
+   double timeNoDummies = 0.0;
 
    // Lambda used to print optimization log.
    Timer tmPrint;
@@ -282,13 +531,30 @@ auto solveColumnGeneration(const CmdParm &parm, const Instance &inst) noexcept -
             setw(16) << "UB   " << 
             setw(16) << "LB   " << 
             setw(12) << "Gap(%)" << 
+            setw(12) << "IGap(%)" << 
             setw(15) << "N.Cols" <<
             setw(10) << "MemMB" << 
          "\n";         
       }
 
       if (force || tmPrint.elapsed() >= 0.3 or linesPrinted % 15 == 0) {
-         double gap = (rmpObj-lbObj)/rmpObj*100.0;
+         // Rows of the recombination have no bound, since the pricing did not run.
+         string lb = "-", gap = "-";
+         if (lbObj > -numeric_limits<double>::infinity()) {
+            ostringstream out;
+            out << fixed << setprecision(2) << lbObj;
+            lb = out.str();
+            out.str("");
+            out << (rmpObj-lbObj)/rmpObj*100.0;
+            gap = out.str();
+         }
+         // Gap of the best known solution.
+         string incGap = "-";
+         if (upperBound < numeric_limits<double>::infinity() && exactPricing) {
+            ostringstream out;
+            out << fixed << setprecision(2) << (upperBound-lagrangianBound)/upperBound*100.0;
+            incGap = out.str();
+         }
          cout <<
             fixed << 
             setw(3) << (masterRelax ? "R" : "E") << 
@@ -297,8 +563,9 @@ auto solveColumnGeneration(const CmdParm &parm, const Instance &inst) noexcept -
             setw(10) << setprecision(2) << timeMaster << 
             setw(10) << setprecision(2) << timePricing << 
             setw(16) << setprecision(2) << rmpObj << 
-            setw(16) << setprecision(2) << lbObj << 
-            setw(12) << setprecision(2) << gap << 
+            setw(16) << lb << 
+            setw(12) << gap << 
+            setw(12) << incGap << 
             setw(15) << (to_string(master->numColumns()) + string("+") + to_string(newCols)) <<
             setw(10) << setprecision(2) << getMemoryUsageKb()/1024.0 << 
          "\n";
@@ -315,42 +582,117 @@ auto solveColumnGeneration(const CmdParm &parm, const Instance &inst) noexcept -
    for (iter = 0; ; ++iter) {
       Timer tmInner;
       tmInner.start();
-      rmpObj = master->solve(iter == 0 ? 'd' : 'p');
+      if (racingMaster) {
+         rmpObj = master->solve('r');
+         const auto winner = racingMaster->raceWinner();
+         ++raceWins[masterRelax ? 0 : 1][winner == 'p' ? 0 : winner == 'd' ? 1 : 2];
+      } else if (centralDuals && !certifying) {
+         rmpObj = master->solve('b');
+      } else {
+         rmpObj = master->solve(iter == 0 ? 'd' : 'p');
+      }
       timeMaster += tmInner.elapsed();
+      if (iterNoDummies == -1 && rmpObj < 1e7) {
+         iterNoDummies = iter;
+         timeNoDummies = tm.elapsed();
+      }
 
-      // Solves the pricing subproblems.
-      // This step can be done in parallel, with some observation when
-      // using GLPK to solve the pricing subproblems.
-      lbObj = rmpObj;      
-      newCols = 0;
-      tmInner.start();
-      #pragma omp parallel for default(shared) schedule(static, 1) num_threads(maxThreads)
-      for (size_t i = 0; i < pricing.size(); ++i) {
-         auto &sp = pricing[i];
-         // This method already takes the dual multipliers from the master.
-         // All the work of updating subproblem obj is managed internally.
-         sp->solve();
-      }
-      timePricing += tmInner.elapsed();
-
-      // Test for negative reduced costs and add columns into RMP.
-      for (size_t i = 0; i < pricing.size(); ++i) {
-         auto &sp = pricing[i];
-         const auto pobj = sp->getObjValue();
-
-         lbObj += pobj;
-         if (pobj <= -0.0001) {
-            // We could find new columns with negative reduced cost!
-            // Add them into RMP.
-            newCols += sp->generateColumns();
+      // The pricing only runs when recombining the columns of the solution gives no new column.
+      // The interior solutions of the barrier give a positive value to every column, so the
+      // recombination waits for the simplex.
+      bool recombined = false;
+      if (recombination && !(centralDuals && !certifying) && !MdvspSigInt) {
+         tmInner.start();
+         newCols = recombination->generate(*master);
+         timePricing += tmInner.elapsed();
+         if (newCols > 0) {
+            ++numRecombinations;
+            lbObj = -numeric_limits<double>::infinity();
+            recombined = true;
+         }
+      }
+
+      if (!recombined) {
+         // Solves the pricing subproblems.
+         // This step can be done in parallel, with some observation when
+         // using GLPK to solve the pricing subproblems.
+         lbObj = rmpObj;      
+         // The barrier stops short of the optimum, so the bounds, and the reduced-cost fixing,
+         // start from the objective of its duals.
+         if (centralDuals && !certifying) {
+            lbObj = 0.0;
+            for (int i = 0; i < inst.numTrips(); ++i)
+               lbObj += master->getTripDual(i);
+            for (int k = 0; k < inst.numDepots(); ++k)
+               lbObj += inst.depotCapacity(k) * master->getDepotCapDual(k);
+         }
+         lagrangianBound = lbObj;
+         const double rmpBound = lbObj;
+         newCols = 0;
+         tmInner.start();
+         #pragma omp parallel for default(shared) schedule(static, 1) num_threads(maxThreads)
+         for (size_t i = 0; i < pricing.size(); ++i) {
+            auto &sp = pricing[i];
+            // This method already takes the dual multipliers from the master.
+            // All the work of updating subproblem obj is managed internally.
+            sp->solve();
+         }
+         timePricing += tmInner.elapsed();
+
+         // Periodically removes the arcs that cannot take part of solutions better 
+         // than the upper bound.
+         if (rcFixingInterval > 0 && iter > 0 && iter % rcFixingInterval == 0 && upperBound < numeric_limits<double>::infinity()) {
+            tmInner.start();
+            if (const auto removed = reducedCostFixing(inst, rmpBound, upperBound, pricing); removed > 0) {
+               long remaining = 0;
+               for (auto &sp: pricing)
+                  remaining += sp->numDeadheadArcs();
+               cout << "Reduced-cost fixing removed " << removed << " arcs (" << remaining << " remaining).\n";
+            }
+            timePricing += tmInner.elapsed();
+         }
+
+         // Test for negative reduced costs and add columns into RMP.
+         for (size_t i = 0; i < pricing.size(); ++i) {
+            auto &sp = pricing[i];
+            const auto pobj = sp->getObjValue();
+
+            lbObj += pobj;
+            lagrangianBound += inst.depotCapacity(sp->depotId()) * min(0.0, pobj);
+            if (pobj <= -0.0001) {
+               // We could find new columns with negative reduced cost!
+               // Add them into RMP.
+               newCols += sp->generateColumns();
+            }
+         }
+      }
+
+      // Hands the new columns to the pool MIP, and takes its best solution as upper bound.
+      if (poolMip) {
+         poolMip->update(*master);
+         if (poolMip->getObjValue() < upperBound) {
+            upperBound = poolMip->getObjValue();
+            cout << "Pool MIP found a solution of cost " << upperBound << "\n";
          }
       }
       
       // Prints a log row.
       printLog(iter);
+
+      // The solution of the pool MIP is optimal once the bound reaches it. Costs are integral.
+      if (poolMip && exactPricing && ceil(lagrangianBound - 1e-6) >= poolMip->getObjValue()) {
+         printLog(iter, true);
+         cout << "\nSolution of the pool MIP proven optimal.\nStopping the algorithm.\n";
+         break;
+      }
       
-      // Check for stopping criterion.
-      if (!newCols) {
+      // Check for stopping criterion. With central duals, the simplex certifies that no
+      // column is left before stopping, and the barrier resumes if it finds any.
+      if (centralDuals)
+         certifying = !newCols && !certifying;
+      if (certifying) {
+         ++numCertifications;
+      } else if (!newCols) {
          if (masterRelax) {
             masterRelax = false;
             cout << "***** CONVERTING MASTER RELAXATION. *****\n";
@@ -383,6 +725,10 @@ auto solveColumnGeneration(const CmdParm &parm, const Instance &inst) noexcept -
       maxThreads = omp_get_max_threads();
    }
    const auto totalTime = tm.elapsed();
+   if (poolMip) {
+      poolMip->stop();
+      cout << "Pool MIP: " << poolMip->numRounds() << " rounds, best solution " << poolMip->getObjValue() << "\n";
+   }
 
    // Forcibly converts the master problem to SP.
    // This might be necessary for cases which the process was interrupted
@@ -399,194 +745,609 @@ auto solveColumnGeneration(const CmdParm &parm, const Instance &inst) noexcept -
    }
    cout << "Value of RMP relaxation: " << master->getObjValue() << "\n";
    cout << "Total time spent: " << totalTime << " sec\n";
+   cout << "Time spent in the RMP: " << timeMaster << " sec";
+   if (auto *native = dynamic_cast<CgMasterNative *>(master.get()))
+      cout << ", " << native->numIterations() << " simplex iterations";
+   else if (auto *clp = dynamic_cast<CgMasterClp *>(master.get()))
+      cout << ", " << clp->numIterations() << " simplex iterations";
+   cout << " (" << master->getSolverName() << ")\n";
+   cout << "Iterations: " << iter+1 << "\n";
+   cout << "Dummy columns priced out at iteration " << iterNoDummies << ", after " << timeNoDummies << " sec";
+   if (greedyStarts > 0)
+      cout << " (greedy seed: " << greedyStarts << " starts, " << timeGreedy << " sec)\n";
+   else
+      cout << " (no greedy seed)\n";
+   if (recombination)
+      cout << "Iterations solved by recombination: " << numRecombinations << "\n";
+   if (centralDuals)
+      cout << "Simplex certifications of the RMP: " << numCertifications << "\n";
+   if (racingMaster) {
+      const char *phases[] = {"relaxed", "set partitioning"};
+      for (int phase = 0; phase < 2; ++phase) {
+         cout << "Race wins (" << phases[phase] << " RMP): primal " << raceWins[phase][0] << ", dual " << 
+            raceWins[phase][1] << ", barrier " << raceWins[phase][2] << "\n";
+      }
+   }
    cout << "Current memory consumption: " << setprecision(2) << getMemoryUsageKb()/1024.0 << " MB\n";
 
-   master->writeLp("masterFinal.lp");
-   cout << "\nRMP exported to 'masterFinal.lp'.\n";
-   master->exportColumns("cols.txt");
-   cout << "RMP columns exported to 'cols.txt'.\n";  
+   // Files are written in background, from snapshots of the RMP, and the queue
+   // waits for them when this function returns.
+   ExportQueue exports(getEnvExportCompress());
+   auto snapshot = snapshotMaster(inst, *master);
+   auto fname = pushSnapshot(exports, "masterFinal.lp", snapshot, [](CgMasterBase &m, const char *f) { m.writeLp(f); });
+   cout << "\nRMP queued for export to '" << fname << "'.\n";
+   fname = pushSnapshot(exports, "cols.txt", snapshot, [](CgMasterBase &m, const char *f) { m.exportColumns(f); }, false);
+   cout << "RMP columns queued for export to '" << fname << "'.\n";  
+   fname = pushSnapshot(exports, "cols.bin", snapshot, [](CgMasterBase &m, const char *f) { m.exportColumnsBinary(f); }, false);
+   cout << "RMP columns queued for export to '" << fname << "'.\n";
 
    MdvspSigInt = false;
-   exportReducedModel(inst, *master, "comp.lp");
-   cout << "Reduced compact model exported to 'comp.lp'.\n";
+   fname = exports.push("comp.lp", [&inst, arcs = findReducedArcs(inst, *master, pricing)](const char *f) {
+      exportReducedModel(inst, arcs, f);
+   });
+   cout << "Reduced compact model queued for export to '" << fname << "'.\n";
+
+   vector<pair<int, vector<int>>> tcgSchedule;
+   auto tcgValue = solveTruncatedColumnGeneration(inst, *master, pricing, makePricing, upperBound, tcgSchedule, exports);
+   if (poolMip && poolMip->getObjValue() < tcgValue) {
+      tcgValue = poolMip->getObjValue();
+      tcgSchedule = poolMip->getSchedule();
+      cout << "Using the solution of the pool MIP: " << tcgValue << "\n";
+   }
 
-   solveTruncatedColumnGeneration(inst, *master, pricing);
+   // Improves the best schedule by local search. The vehicles changed are fed back 
+   // into the RMP, so the later steps can use them.
+   if (const auto lsRounds = getEnvLocalSearchRounds(); lsRounds > 0 && !tcgSchedule.empty()) {
+      tm.start();
+      LocalSearch ls(inst, tcgSchedule);
+      const auto numMoves = ls.improve(lsRounds);
+      cout << "\nLocal search: " << numMoves << " moves, from " << tcgValue << " to " << ls.getObjValue() << 
+         " in " << tm.elapsed() << " sec\n";
+      if (ls.getObjValue() < tcgValue) {
+         tcgValue = ls.getObjValue();
+         tcgSchedule = ls.getSchedule();
+         cout << "Added " << ls.addColumns(*master) << " improved vehicles into the RMP.\n";
+      }
+   }
+   if (parm.count("solve-reduced") != 0) {
+      MdvspSigInt = false;
+      solveReducedModel(inst, *master, pricing, tcgSchedule, parm["reduced-time-limit"].as<double>());
+   }
+   if (parm.count("branch-and-price") == 0)
+      return EXIT_SUCCESS;
+
+   // Branch-and-price, starting from the columns of the root node.
+   cout << "\n\nStarting branch-and-price!" << endl;
+   BranchAndPrice::MasterFactory makeMaster = [&inst, masterImpl]() -> unique_ptr<CgMasterBase> {
+#ifdef HAVE_CPLEX
+      if (masterImpl == "cplex")
+         return make_unique<CgMasterCplex>(inst);
+#endif
+      if (masterImpl == "clp")
+         return make_unique<CgMasterClp>(inst);
+      if (masterImpl == "native")
+         return make_unique<CgMasterNative>(inst);
+      return make_unique<CgMasterGlpk>(inst);
+   };
+   BranchAndPrice bp(inst, makeMaster, makePricing, getEnvContractTripChains());
+   bp.addColumns(*master);
+   bp.setIncumbentValue(min(upperBound, tcgValue));
+   if (parm.count("bp-checkpoint") != 0) {
+      const auto fname = parm["bp-checkpoint"].as<string>();
+      if (ifstream(fname).good()) {
+         if (!bp.loadCheckpoint(fname))
+            return EXIT_FAILURE;
+         cout << "Resuming the search saved in '" << fname << "'.\n";
+      }
+      bp.setCheckpoint(fname, getEnvBpCheckpointInterval());
+   }
+
+   // GLPK problems must stay in the thread that created them, so the nodes are solved
+   // by a single thread when GLPK takes part.
+   int bpThreads = omp_get_max_threads();
+   if (masterImpl == "glpk" || dynamic_cast<PricingGlpk *>(pricing.front().get()) != nullptr) {
+      cout << "Branch-and-price runs in a single thread with GLPK.\n";
+      bpThreads = 1;
+   }
+
+   MdvspSigInt = false;
+   tm.start();
+   const bool finished = bp.solve(bpThreads, parm["bp-time-limit"].as<double>());
+
+   cout << "\n";
+   if (!finished)
+      cout << "WARNING: Branch-and-price stopped before proving optimality.\n";
+   cout << "Branch-and-price nodes: " << bp.numNodes() << "\n";
+   cout << "Columns in the pool: " << bp.numColumns() << "\n";
+   cout << "Best solution: " << bp.incumbentValue() << "\n";
+   cout << "Lower bound: " << bp.lowerBound() << "\n";
+   cout << "Total time spent: " << tm.elapsed() << " sec\n";
+   if (bp.incumbentSchedule().empty())
+      cout << "No solution better than the truncated column generation was found.\n";
+   else
+      cout << "Best solution uses " << bp.incumbentSchedule().size() << " vehicles.\n";
 
    return EXIT_SUCCESS;
 }
 
-auto exportReducedModel(const Instance &inst, const CgMasterBase &rmp, const char outName[]) noexcept -> void {
-   // This is mostly the same as the instance matrix, and we use it as a cache of
-   // arcs present in the RMP solution.
-   const auto L = inst.numDepots() + inst.numTrips();
-   const auto K = inst.numDepots();
-   const auto O = inst.numTrips();
-   const auto D = inst.numTrips() + 1;
+auto solveLagrangian(const CmdParm &parm, const Instance &inst) noexcept -> int {
+   cout << "Solution method of choice: Lagrangian relaxation\n";
 
-   boost::multi_array<char, 3> present(boost::extents[K][L][L]);
-   fill_n(present.data(), present.num_elements(), 0);
+   // Only the pricing subproblems are built, since the multipliers are updated by subgradient
+   // instead of a master problem.
+   int maxThreads = omp_get_max_threads();
+   Timer tm;
+   tm.start();
+   cout << "\nBuilding pricing subproblems.\n";
+   unique_ptr<TimeSpaceNetwork> network;
+   bool pricingPathControl = true;
+   const auto makePricing = createPricingFactory(parm, inst, network, pricingPathControl, maxThreads);
+   if (!makePricing)
+      return EXIT_FAILURE;
+
+   LagrangianMaster lagrangian(inst);
+   vector<unique_ptr<CgPricingBase>> pricing;
+   for (int k = 0; k < inst.numDepots(); ++k) {
+      pricing.emplace_back(makePricing(lagrangian, k));
+      pricing.back()->setMaxLabelExpansionsPerNode(getEnvMaxLabelExpansions());
+   }
+   cout << "Solver: " << pricing.front()->getSolverName() << "\n";
+   cout << "Build time: " << tm.elapsed() << " sec\n";
 
-   // Walks through the paths and set the arcs as "present".
-   for (int j = 0; j < rmp.numColumns(); ++j) {
-      const auto &path{rmp.columnPath(j)};
-      // This part of the code only sets the deadheading arcs.
-      for (size_t i = 1; i < path.size(); ++i) {
-         present[rmp.columnDepot(j)][path[i - 1]][path[i]] = 1;
+   unique_ptr<TripChains> chains;
+   if (getEnvContractTripChains()) {
+      chains.reset(new TripChains(inst));
+      cout << "Contracted " << chains->numContractedTrips() << " trips into " << chains->numChains() << " chains.\n";
+      lagrangian.setTripChains(chains.get());
+      for (auto &k: pricing) {
+         k->setTripChains(chains.get());
       }
+   }
 
-      // Now set the souce and sink arcs.
-      present[rmp.columnDepot(j)][O][path.front()] = 1;
-      present[rmp.columnDepot(j)][path.back()][D] = 1;
+   // The upper bound sets the step size of the subgradient.
+   double upperBound = numeric_limits<double>::infinity();
+   if (parm.count("upper-bound") != 0) {
+      upperBound = parm["upper-bound"].as<double>();
+      cout << "Using upper bound: " << upperBound << "\n";
+   }
+   if (const auto greedyStarts = getEnvGreedyStarts(); greedyStarts > 0) {
+      GreedyHeuristic heur(inst);
+      if (heur.solve(greedyStarts) && heur.getObjValue() < upperBound) {
+         upperBound = heur.getObjValue();
+         cout << "Using upper bound of the greedy heuristic: " << upperBound << "\n";
+      }
    }
 
-   char buf[128];
-   glp_prob *model = glp_create_prob();
+   // The bound is only valid when the subproblems are solved to optimality.
+   bool exactPricing = true;
+   for (auto &sp: pricing)
+      exactPricing = exactPricing && sp->isExact() && sp->maxLabelExpansionsPerNode() == numeric_limits<int>::max();
 
-   glp_set_prob_name(model, "reduced_compact_mdvsp_glpk");
-   glp_set_obj_dir(model, GLP_MIN);
+   cout << "\nStarting Lagrangian relaxation.\n";
+   tm.start();
+   const auto bound = lagrangian.optimize(pricing, getEnvLagrangianIterations(), upperBound, maxThreads);
+   cout << "Lagrangian bound: " << fixed << setprecision(2) << bound << " (" << lagrangian.numIterations() << 
+      " iterations, " << lagrangian.numColumns() << " paths, " << tm.elapsed() << " sec)\n";
+   if (!exactPricing)
+      cout << "WARNING: The pricing is not exact, so the bound may not be valid.\n";
+   if (upperBound < numeric_limits<double>::infinity())
+      cout << "Gap to the upper bound: " << (upperBound - bound) / upperBound * 100.0 << "%\n";
+   cout << "Current memory consumption: " << setprecision(2) << getMemoryUsageKb()/1024.0 << " MB\n";
 
-   // Create the variables.
-   const auto N = inst.numTrips() + 2;
+   return EXIT_SUCCESS;
+}
 
-   boost::multi_array<int, 3> x(boost::extents[inst.numDepots()][N][N]);
-   fill_n(x.data(), x.num_elements(), -1);
+auto createPricingFactory(const CmdParm &parm, const Instance &inst, unique_ptr<TimeSpaceNetwork> &network, bool &pathControl, int &maxThreads) noexcept -> PricingFactory {
+   // Parses the parameter of max-paths.
+   const int maxPaths = parm["max-paths"].as<int>();
+   if (maxPaths <= 0) {
+      cout << "Parameter --max-paths need to be >= 1.\n";
+      return nullptr;
+   }
 
-   for (int i = 0; i < inst.numTrips(); ++i) {
-      // Creates source arcs.
-      for (int k = 0; k < inst.numDepots(); ++k) {
-         if (auto cost = inst.sourceCost(k, i); present[k][O][i]) {
-            snprintf(buf, sizeof buf, "source#%d#%d#%d", k, O, i);
-            int col = x[k][O][i] = glp_add_cols(model, 1);
-            glp_set_col_name(model, col, buf);
-            glp_set_obj_coef(model, col, cost);
-            glp_set_col_bnds(model, col, GLP_DB, 0.0, 1.0);
-            glp_set_col_kind(model, col, GLP_BV);
-         }
+   // The time-space network is shared by all subproblems.
+   const auto pricingImpl = parm["pricing"].as<string>();
+   if (pricingImpl == "timespace") {
+      if (parm.count("timetable") == 0) {
+         cout << "Pricing timespace requires --timetable.\n";
+         return nullptr;
       }
+      network.reset(new TimeSpaceNetwork(inst, parm["timetable"].as<string>().c_str()));
+      cout << "Time-space network: " << network->numNodes() << " nodes, " << network->numArcs() << " arcs.\n";
+   }
 
-      // Creates sink arcs.
-      for (int k = 0; k < inst.numDepots(); ++k) {
-         if (auto cost = inst.sinkCost(k, i); present[k][i][D]) {
-            snprintf(buf, sizeof buf, "sink#%d#%d#%d", k, i, D);
-            int col = x[k][i][D] = glp_add_cols(model, 1);
-            glp_set_col_name(model, col, buf);
-            glp_set_obj_coef(model, col, cost);
-            glp_set_col_bnds(model, col, GLP_DB, 0.0, 1.0);
-            glp_set_col_kind(model, col, GLP_BV);
-         }
-      }
+   // The factory is also used to create the subproblems of cloned master problems.
+   PricingFactory makePricing;
+   if (pricingImpl == "spfa") {
+      makePricing = [&inst, maxPaths](CgMasterBase &rmp, int k) -> unique_ptr<CgPricingBase> {
+         return make_unique<PricingSpfa>(inst, rmp, k, maxPaths == 1);
+      };
+      pathControl = false;
+   } else if (pricingImpl == "timespace") {
+      makePricing = [&inst, maxPaths, net = network.get()](CgMasterBase &rmp, int k) -> unique_ptr<CgPricingBase> {
+         return make_unique<PricingTimeSpace>(inst, rmp, k, *net, maxPaths == 1);
+      };
+      pathControl = false;
+   } else if (pricingImpl == "bellman") {
+      makePricing = [&inst, maxPaths](CgMasterBase &rmp, int k) -> unique_ptr<CgPricingBase> {
+         return make_unique<PricingBellman>(inst, rmp, k, maxPaths == 1);
+      };
+      pathControl = false;
+   } else if (pricingImpl == "glpk") {
+      makePricing = [&inst, maxPaths](CgMasterBase &rmp, int k) -> unique_ptr<CgPricingBase> {
+         return make_unique<PricingGlpk>(inst, rmp, k, maxPaths);
+      };
+      maxThreads = 1; // To circumvent problems with GLPK and multi-threading applications
+      #ifdef MIP_PRICING_LP
+         cout << "Solving pricing subproblems as LP.\n";
+      #endif
+   } else if (pricingImpl == "cbc") {
+      makePricing = [&inst, maxPaths](CgMasterBase &rmp, int k) -> unique_ptr<CgPricingBase> {
+         return make_unique<PricingCbc>(inst, rmp, k, maxPaths);
+      };
+      #ifdef MIP_PRICING_LP
+         cout << "Solving pricing subproblems as LP.\n";
+      #endif
+   } 
+#ifdef HAVE_CPLEX
+   else if (pricingImpl == "cplex") {
+      makePricing = [&inst, maxPaths](CgMasterBase &rmp, int k) -> unique_ptr<CgPricingBase> {
+         return make_unique<PricingCplex>(inst, rmp, k, maxPaths);
+      };
+      #ifdef MIP_PRICING_LP
+         cout << "Solving pricing subproblems as LP.\n";
+      #endif
+   } 
+#endif
+   else {
+      cout << "Unknown implementation for pricing solver: " << pricingImpl << ".\n";
+      return nullptr;
+   }
 
-      // Adds all deadheading arcs.
-      for (auto &p : inst.deadheadSuccAdj(i)) {
-         for (int k = 0; k < inst.numDepots(); ++k) {
-            if (present[k][i][p.first]) {
-               snprintf(buf, sizeof buf, "deadhead#%d#%d#%d", k, i, p.first);
-               int col = x[k][i][p.first] = glp_add_cols(model, 1);
-               glp_set_col_name(model, col, buf);
-               glp_set_obj_coef(model, col, p.second);
-               glp_set_col_bnds(model, col, GLP_DB, 0.0, 1.0);
-               glp_set_col_kind(model, col, GLP_BV);
-            }
+   return makePricing;
+}
+
+auto findReducedArcs(const Instance &inst, const CgMasterBase &rmp, const vector<unique_ptr<CgPricingBase>> &pricing) noexcept -> vector<ReducedArc> {
+   const auto O = inst.numTrips();
+   const auto D = inst.numTrips() + 1;
+
+   // Each thread collects the arcs of a share of the columns.
+   vector<vector<ReducedArc>> local(omp_get_max_threads());
+   #pragma omp parallel default(shared)
+   {
+      auto &arcs = local[omp_get_thread_num()];
+      #pragma omp for schedule(static)
+      for (int j = 0; j < rmp.numColumns(); ++j) {
+         const auto k = rmp.columnDepot(j);
+         const auto &path{rmp.columnPath(j)};
+         const auto &sp{pricing[k]};
+         // This part of the code only sets the deadheading arcs. Arcs removed by
+         // reduced-cost fixing are not included.
+         for (size_t i = 1; i < path.size(); ++i) {
+            if (sp->hasDeadheadArc(path[i - 1], path[i]))
+               arcs.emplace_back(k, path[i - 1], path[i]);
          }
+
+         // Now set the souce and sink arcs.
+         arcs.emplace_back(k, O, path.front());
+         arcs.emplace_back(k, path.back(), D);
       }
+      sort(arcs.begin(), arcs.end());
+      arcs.erase(unique(arcs.begin(), arcs.end()), arcs.end());
    }
 
-   // Adds the assignment constraints.
-   for (int i = 0; i < inst.numTrips(); ++i) {
-      vector<int> cols = {0};
-      vector<double> coefs = {0.0};
+   vector<ReducedArc> arcs;
+   for (auto &l: local) {
+      arcs.insert(arcs.end(), l.begin(), l.end());
+      vector<ReducedArc>().swap(l);
+   }
+   sort(arcs.begin(), arcs.end());
+   arcs.erase(unique(arcs.begin(), arcs.end()), arcs.end());
+   return arcs;
+}
 
-      for (int k = 0; k < inst.numDepots(); ++k) {
-         for (auto &p : inst.deadheadSuccAdj(i)) {
-            if (present[k][i][p.first]) {
-               auto colId = x[k][i][p.first];
-               assert(colId != -1);
-               cols.push_back(colId);
-               coefs.push_back(1.0);
-            }
+auto exportReducedModel(const Instance &inst, const vector<ReducedArc> &arcs, const char outName[]) noexcept -> void {
+   const auto K = inst.numDepots();
+   const auto O = inst.numTrips();
+   const auto D = inst.numTrips() + 1;
+   const auto V = inst.numTrips() + 2;
+   const long numArcs = arcs.size();
+
+   // Arcs are sorted by (depot, pred, succ), so the arcs leaving node i of depot k 
+   // are arcs[outStart[k*V+i]] ... arcs[outStart[k*V+i+1]-1]. The arcs entering
+   // each node are indexed by inArcs in the same way.
+   vector<long> outStart(K * V + 1, 0), inStart(K * V + 1, 0);
+   for (const auto &[k, i, j]: arcs) {
+      ++outStart[k * V + i + 1];
+      ++inStart[k * V + j + 1];
+   }
+   partial_sum(outStart.begin(), outStart.end(), outStart.begin());
+   partial_sum(inStart.begin(), inStart.end(), inStart.begin());
+   vector<long> inArcs(numArcs), inPos(inStart.begin(), inStart.end() - 1);
+   for (long a = 0; a < numArcs; ++a) {
+      const auto &[k, i, j] = arcs[a];
+      inArcs[inPos[k * V + j]++] = a;
+   }
+
+   auto name = [&](long a) {
+      const auto &[k, i, j] = arcs[a];
+      char buf[128];
+      if (i == O)
+         snprintf(buf, sizeof buf, "source#%d#%d#%d", k, i, j);
+      else if (j == D)
+         snprintf(buf, sizeof buf, "sink#%d#%d#%d", k, i, j);
+      else
+         snprintf(buf, sizeof buf, "deadhead#%d#%d#%d", k, i, j);
+      return string(buf);
+   };
+   auto cost = [&](long a) {
+      const auto &[k, i, j] = arcs[a];
+      if (i == O)
+         return inst.sourceCost(k, j);
+      if (j == D)
+         return inst.sinkCost(k, i);
+      return inst.deadheadCost(i, j);
+   };
+
+   // Appends a term to a row, breaking lines as they grow.
+   auto addTerm = [](string &row, size_t &lineStart, const string &coef, const string &var) {
+      if (row.size() - lineStart > 200) {
+         row += "\n";
+         lineStart = row.size();
+      }
+      row += " " + coef + " " + var;
+   };
+
+   // Rows without arcs, e.g., a trip whose arcs were all fixed to zero, get a zero 
+   // term, as the LP format does not accept constraints without terms.
+   atomic<int> numEmptyRows{0};
+   auto closeRow = [&](string &row, bool empty, const string &rhs) {
+      if (empty) {
+         row += numArcs > 0 ? " 0 " + name(0) : " 0 dummy";
+         ++numEmptyRows;
+      }
+      row += rhs;
+   };
+
+   // Rows are formatted in parallel, one block at a time, and streamed to the file.
+   ofstream out(outName);
+   auto writeRows = [&](long numRows, const function<void(long, string &)> &format) {
+      const long blockSize = 4096;
+      vector<string> block(blockSize);
+      for (long first = 0; first < numRows; first += blockSize) {
+         const long last = min(numRows, first + blockSize);
+         #pragma omp parallel for default(shared) schedule(dynamic, 64)
+         for (long r = first; r < last; ++r) {
+            block[r - first].clear();
+            format(r, block[r - first]);
          }
-         if (auto colId = x[k][i][D]; present[k][i][D] && colId != -1) {
-            cols.push_back(colId);
-            coefs.push_back(1.0);
+         for (long r = first; r < last; ++r)
+            out << block[r - first];
+      }
+   };
+
+   out << "\\* Problem: reduced_compact_mdvsp *\\\n\nMinimize\n obj:";
+   const long termsPerRow = 1024;
+   writeRows((numArcs + termsPerRow - 1) / termsPerRow, [&](long r, string &row) {
+      size_t lineStart = 0;
+      for (long a = r * termsPerRow; a < min(numArcs, (r + 1) * termsPerRow); ++a)
+         addTerm(row, lineStart, "+ " + to_string(cost(a)), name(a));
+      row += "\n";
+   });
+
+   // Adds the assignment constraints.
+   out << "\nSubject To\n";
+   writeRows(inst.numTrips(), [&](long i, string &row) {
+      row = " assignment#" + to_string(i) + ":";
+      size_t lineStart = 0;
+      bool empty = true;
+      for (int k = 0; k < K; ++k) {
+         for (long a = outStart[k * V + i]; a < outStart[k * V + i + 1]; ++a) {
+            addTerm(row, lineStart, "+", name(a));
+            empty = false;
          }
       }
+      closeRow(row, empty, " = 1\n");
+   });
+
+   // Adds the flow conservation constraints.
+   writeRows(long(inst.numTrips()) * K, [&](long r, string &row) {
+      const int i = r / K, k = r % K;
+      const long node = k * V + i;
+      if (inStart[node] == inStart[node + 1] && outStart[node] == outStart[node + 1])
+         return;
+      row = " flow_consevation#" + to_string(k) + "#" + to_string(i) + ":";
+      size_t lineStart = 0;
+      for (long pos = inStart[node]; pos < inStart[node + 1]; ++pos)
+         addTerm(row, lineStart, "+", name(inArcs[pos]));
+      for (long a = outStart[node]; a < outStart[node + 1]; ++a)
+         addTerm(row, lineStart, "-", name(a));
+      row += " = 0\n";
+   });
 
-      int row = glp_add_rows(model, 1);
-      snprintf(buf, sizeof buf, "assignment#%d", i);
-      glp_set_row_name(model, row, buf);
-      glp_set_row_bnds(model, row, GLP_FX, 1.0, 1.0);
-      glp_set_mat_row(model, row, cols.size()-1, cols.data(), coefs.data());
+   // Adds the depot capacity constraints.
+   writeRows(K, [&](long k, string &row) {
+      row = " depot_cap#" + to_string(k) + ":";
+      size_t lineStart = 0;
+      for (long a = outStart[k * V + O]; a < outStart[k * V + O + 1]; ++a)
+         addTerm(row, lineStart, "+", name(a));
+      closeRow(row, outStart[k * V + O] == outStart[k * V + O + 1], " <= " + to_string(inst.depotCapacity(k)) + "\n");
+   });
+
+   out << "\nBinaries\n";
+   writeRows(numArcs, [&](long a, string &row) {
+      row = " " + name(a) + "\n";
+   });
+   out << "\nEnd\n";
+
+   if (numEmptyRows > 0)
+      cout << "WARNING: " << numEmptyRows << " rows of '" << outName << "' have no arcs, and were written with a zero term.\n";
+}
+
+auto solveReducedModel(const Instance &inst, const CgMasterBase &rmp, const vector<unique_ptr<CgPricingBase>> &pricing, const vector<pair<int, vector<int>>> &schedule, double timeLimit) noexcept -> void {
+   cout << "\n\nSolving the reduced compact model with CBC." << endl;
+   Timer tm;
+   tm.start();
+
+   // The arcs of the MIP start are kept, even if removed by reduced-cost fixing.
+   auto arcs = findReducedArcs(inst, rmp, pricing);
+   for (const auto &[k, trips]: schedule) {
+      arcs.emplace_back(k, inst.numTrips(), trips.front());
+      arcs.emplace_back(k, trips.back(), inst.numTrips() + 1);
+      for (size_t pos = 1; pos < trips.size(); ++pos)
+         arcs.emplace_back(k, trips[pos - 1], trips[pos]);
+   }
+   sort(arcs.begin(), arcs.end());
+   arcs.erase(unique(arcs.begin(), arcs.end()), arcs.end());
+   ModelCbc model(inst, [&arcs](int k, int i, int j) { return binary_search(arcs.begin(), arcs.end(), ReducedArc(k, i, j)); });
+   cout << "Reduced model: " << model.numColumns() << " columns, " << model.numRows() << " rows, built in " << 
+      tm.elapsed() << " sec" << endl;
+
+   if (!schedule.empty()) {
+      if (model.setMipStart(schedule))
+         cout << "Using the TCG solution as MIP start." << endl;
+      else
+         cout << "WARNING: The TCG solution does not fit the reduced model." << endl;
    }
 
-   // Adds the flow conservation constraints.
-   for (int i = 0; i < inst.numTrips(); ++i) {
-      for (int k = 0; k < inst.numDepots(); ++k) {
-         vector<int> cols = {0};
-         vector<double> coefs = {0.0};
+   tm.start();
+   const int numThreads = omp_get_max_threads();
+   const bool optimal = model.solve(numThreads, timeLimit);
+   cout << "\nReduced model solved with " << numThreads << " threads in " << tm.elapsed() << " sec, " <<
+      model.getNodeCount() << " nodes\n";
+   if (!optimal)
+      cout << "WARNING: Optimality of the reduced model was not proven.\n";
+   cout << "Reduced model solution: " << model.getObjValue() << "\n";
+   cout << "Reduced model bound: " << model.getBestBound() << endl;
+}
 
-         if (auto colId = x[k][O][i]; colId != -1) {
-            cols.push_back(colId);
-            coefs.push_back(1.0);
-         }
+auto solveTruncatedColumnGeneration(const Instance &inst, CgMasterBase &rmp, vector<unique_ptr<CgPricingBase>> &pricing, const PricingFactory &makePricing, double upperBound, vector<pair<int, vector<int>>> &schedule, ExportQueue &exports) noexcept -> double {
+   cout << "\n\nStarting truncated column generation!" << endl;
+   Timer timer;
+   timer.start();
 
-         if (auto colId = x[k][i][D]; colId != -1) {
-            cols.push_back(colId);
-            coefs.push_back(-1.0);
-         }
+   for (auto &k: pricing) {
+      k->setMaxLabelExpansionsPerNode(getEnvMaxLabelExpansionsTcg());
+   }
 
-         for (auto &p : inst.deadheadPredAdj(i)) {
-            if (present[k][p.first][i]) {
-               auto colId = x[k][p.first][i];
-               assert(colId != -1);
-               cols.push_back(colId);
-               coefs.push_back(1.0);
-            }
-         }
+   TcgSettings settings;
+   settings.varSelection = getEnvTcgVarSelection();
+   settings.graspStrategy = getEnvTcgGraspStrategy();
+   settings.graspAlpha = getEnvTcgGraspAlpha();
+   settings.maxSubIterations = getEnvMaxTcgSubIter();
+   settings.rcFixingInterval = getEnvRcFixingInterval();
+   settings.fixThreshold = getEnvTcgFixThreshold();
+   settings.fixTopK = getEnvTcgFixTopK();
+   settings.maxBacktracks = getEnvTcgBacktracks();
+   settings.backtrackDepth = getEnvTcgBacktrackDepth();
+   settings.backtrackThreshold = getEnvTcgBacktrackThreshold();
+
+   int numDives = getEnvTcgDives();
+   if (numDives > 1 && settings.varSelection == TCG_VAR_SEL_SIMPLE) {
+      cout << "WARNING: Dives are deterministic with TCG_VAR_SEL=simple. Running a single dive.\n";
+      numDives = 1;
+   }
 
-         for (auto &p : inst.deadheadSuccAdj(i)) {
-            if (present[k][i][p.first]) {
-               auto colId = x[k][i][p.first];
-               assert(colId != -1);
-               cols.push_back(colId);
-               coefs.push_back(-1.0);
-            }
+   // GLPK keeps its memory in an environment per thread, so its problems must be
+   // created, solved and deleted by the same thread.
+   const bool usesGlpk = dynamic_cast<CgMasterGlpk *>(&rmp) != nullptr || 
+      (!pricing.empty() && dynamic_cast<PricingGlpk *>(pricing.front().get()) != nullptr);
+   if (numDives > 1 && usesGlpk) {
+      cout << "WARNING: Parallel dives are not supported with GLPK. Running a single dive.\n";
+      numDives = 1;
+   }
+
+   atomic<double> incumbent{numeric_limits<double>::infinity()};
+   CgMasterBase *best = &rmp;
+   vector<unique_ptr<CgMasterBase>> diveRmp;
+
+   if (numDives == 1) {
+      // The dive fixes arcs by reduced cost against bounds that only hold under its own
+      // column fixings, so it works on copies of the subproblems. The arc views of the
+      // root subproblems are still used after the TCG.
+      vector<unique_ptr<CgPricingBase>> divePricing;
+      for (auto &sp: pricing) {
+         divePricing.emplace_back(makePricing(rmp, sp->depotId()));
+         divePricing.back()->inheritFrom(*sp);
+      }
+      incumbent = graspDive(inst, rmp, divePricing, settings, upperBound, 1, incumbent, true);
+   } else {
+      // Each dive owns a copy of the master problem and of the subproblems. The copies 
+      // are created upfront, since the solvers are not safe to copy concurrently.
+      vector<vector<unique_ptr<CgPricingBase>>> divePricing(numDives);
+      diveRmp.resize(numDives);
+      for (int d = 0; d < numDives; ++d) {
+         diveRmp[d] = rmp.clone();
+         for (auto &sp: pricing) {
+            divePricing[d].emplace_back(makePricing(*diveRmp[d], sp->depotId()));
+            divePricing[d].back()->inheritFrom(*sp);
          }
+      }
+      cout << "Running " << numDives << " dives with up to " << omp_get_max_threads() << " threads." << endl;
 
-         if (cols.size() > 1) {
-            int row = glp_add_rows(model, 1);
-            snprintf(buf, sizeof buf, "flow_consevation#%d#%d", k, i);
-            glp_set_row_name(model, row, buf);
-            glp_set_row_bnds(model, row, GLP_FX, 0.0, 0.0);
-            glp_set_mat_row(model, row, cols.size() - 1, cols.data(), coefs.data());
+      int bestDive = -1;
+      #pragma omp parallel for default(shared) schedule(dynamic, 1)
+      for (int d = 0; d < numDives; ++d) {
+         if (MdvspSigInt)
+            continue;
+         Timer diveTimer;
+         diveTimer.start();
+         const auto value = graspDive(inst, *diveRmp[d], divePricing[d], settings, upperBound, d + 1, incumbent, false);
+         
+         #pragma omp critical
+         {
+            if (value < incumbent) {
+               incumbent = value;
+               bestDive = d;
+            }
+            cout << "Dive " << d << ": ";
+            if (value < numeric_limits<double>::infinity())
+               cout << "solution " << value;
+            else
+               cout << "abandoned";
+            cout << " after " << diveTimer.elapsed() << " sec (best: " << incumbent << ")" << endl;
          }
       }
+      
+      if (bestDive != -1)
+         best = diveRmp[bestDive].get();
    }
 
-   // Adds the depot capacity constraints.
-   for (int k = 0; k < inst.numDepots(); ++k) {
-      vector<int> cols = {0};
-      vector<double> coefs = {0.0};
+   cout << "Truncated column generation finished after " << timer.elapsed() << " seconds" << endl;
+   cout << "Best TCG solution: " << incumbent << endl;
 
-      for (int i = 0; i < inst.numTrips(); ++i) {
-         if (auto colId = x[k][O][i]; colId != -1) {
-            cols.push_back(colId);
-            coefs.push_back(1.0);
-         }
+   schedule.clear();
+   if (incumbent < numeric_limits<double>::infinity()) {
+      for (int col = 0; col < best->numColumns(); ++col) {
+         if (best->getLb(col) >= 0.5)
+            schedule.emplace_back(best->columnDepot(col), best->columnPath(col));
       }
-
-      int row = glp_add_rows(model, 1);
-      snprintf(buf, sizeof buf, "depot_cap#%d", k);
-      glp_set_row_name(model, row, buf);
-      glp_set_row_bnds(model, row, GLP_UP, 0.0, inst.depotCapacity(k));
-      glp_set_mat_row(model, row, cols.size() - 1, cols.data(), coefs.data());
    }
 
-   glp_write_lp(model, nullptr, outName);
-   glp_delete_prob(model);
+   // The variants of the final master problem are written in background, in order,
+   // from a single snapshot.
+   auto snapshot = snapshotMaster(inst, *best);
+   pushSnapshot(exports, "masterTcgFix.lp", snapshot, [](CgMasterBase &m, const char *f) { m.writeLp(f); });
+   pushSnapshot(exports, "masterTcgFixInt.lp", snapshot, [](CgMasterBase &m, const char *f) {
+      m.convertToBinary();
+      m.writeLp(f);
+   });
+   pushSnapshot(exports, "masterTcgInt.lp", snapshot, [](CgMasterBase &m, const char *f) {
+      for (int col = 0; col < m.numColumns(); ++col)
+         m.setLb(col, 0.0);
+      m.writeLp(f);
+   });
+   pushSnapshot(exports, "masterTcg.lp", snapshot, [](CgMasterBase &m, const char *f) {
+      m.convertToRelaxed();
+      m.writeLp(f);
+   });
+   for (int col = 0; col < best->numColumns(); ++col)
+      best->setLb(col, 0.0);
+
+   return incumbent;
 }
 
-auto solveTruncatedColumnGeneration(const Instance &inst, CgMasterBase &rmp, vector<unique_ptr<CgPricingBase>> &pricing) noexcept -> void {
-   cout << "\n\nStarting truncated column generation!" << endl;
+auto graspDive(const Instance &inst, CgMasterBase &rmp, vector<unique_ptr<CgPricingBase>> &pricing, const TcgSettings &settings, double upperBound, unsigned seed, const atomic<double> &incumbent, bool verbose) noexcept -> double {
    int maxThreads = 1;
    int iter = 0;
    Timer timer;
@@ -595,14 +1356,6 @@ auto solveTruncatedColumnGeneration(const Instance &inst, CgMasterBase &rmp, vec
    vector<char> tripCovers(inst.numTrips(), 0);
    int coverCount = 0;
 
-   for (auto &k: pricing) {
-      k->setMaxLabelExpansionsPerNode(getEnvMaxLabelExpansionsTcg());
-   }
-
-   const auto varSelection = getEnvTcgVarSelection();
-   const auto graspStrategy = getEnvTcgGraspStrategy();
-   const auto graspAlpha = getEnvTcgGraspAlpha();
-
    struct Candidate {
       int column;
       double cost;
@@ -618,7 +1371,8 @@ auto solveTruncatedColumnGeneration(const Instance &inst, CgMasterBase &rmp, vec
    };
 
    vector<Candidate> graspCandidates;
-   mt19937 rng{1};
+   vector<unique_ptr<CgMasterBase>> evalWorkers;
+   mt19937 rng{seed};
    uniform_int_distribution<std::size_t> dist(0, 1);
 
 
@@ -641,18 +1395,55 @@ auto solveTruncatedColumnGeneration(const Instance &inst, CgMasterBase &rmp, vec
       }
    };
 
-   const auto maxTcgSubIterations = getEnvMaxTcgSubIter();
+   // Vehicles used by the fixed columns of each depot. Batches never exceed the
+   // depot capacities, so the RMP remains feasible.
+   vector<int> depotFixed(inst.numDepots(), 0);
+
+   auto fixColumn = [&](int col) -> void {
+      rmp.setLb(col, 1.0);
+      updateCoverCount(col);
+      ++depotFixed[rmp.columnDepot(col)];
+   };
+
+   auto unfixColumn = [&](int col) -> void {
+      rmp.setLb(col, 0.0);
+      for (int trip: rmp.getTripsCovered(col)) {
+         tripCovers[trip] = 0;
+         --coverCount;
+      }
+      --depotFixed[rmp.columnDepot(col)];
+   };
+
+   // Columns fixed in the last round, besides the selected one. When the batch
+   // leaves the RMP relying on dummy columns, it is undone and the dive falls 
+   // back to fixing a single column per round.
+   bool batchFixing = settings.fixTopK > 1 || settings.fixThreshold > 0.0;
+   vector<int> lastBatch;
+   int rmpSolves = 0;
+
+   // Limited-discrepancy backtracking. The most recent rounds are kept with the
+   // columns they fixed, the alternatives left in their candidate lists, and the
+   // basis of the RMP before the fixing.
+   struct Decision {
+      vector<int> fixed;
+      vector<int> alternatives;
+      CgMasterBase::Basis basis;
+      double rmpObj;
+   };
+   deque<Decision> decisions;
+   int backtracksLeft = settings.maxBacktracks;
 
    for (;!MdvspSigInt;++iter) {
 
       // Runs the CG algorithm.
       double rmpObj;
+      double lbObj = -numeric_limits<double>::infinity();
       bool optimizeRmp = true;
 
-      for (int cgIter = 0; (cgIter < maxTcgSubIterations || rmpObj >= 1e7) && !MdvspSigInt; ++cgIter) {
-         bool continueCg = false;
+      for (int cgIter = 0; (cgIter < settings.maxSubIterations || rmpObj >= 1e7) && !MdvspSigInt; ++cgIter) {
          int newCols = 0;
          rmpObj = rmp.solve(cgIter == 0 ? 'd' : 'p');
+         ++rmpSolves;
          
          #pragma omp parallel for default(shared) schedule(static, 1) num_threads(maxThreads)
          for (size_t i = 0; i < pricing.size(); ++i) {
@@ -661,15 +1452,29 @@ auto solveTruncatedColumnGeneration(const Instance &inst, CgMasterBase &rmp, vec
             // All the work of updating subproblem obj is managed internally.
             sp->solve();
          }
+
+         // The RMP bound with fixed columns is a bound for the remainder of the dive,
+         // so arcs fixed here are useless for completing the current partial solution.
+         // Backtracking reverts column fixings, but not the arcs fixed under them.
+         const double diveUpperBound = min<double>(upperBound, incumbent);
+         if (settings.rcFixingInterval > 0 && settings.maxBacktracks == 0 && cgIter == 0 && iter % settings.rcFixingInterval == 0 && diveUpperBound < numeric_limits<double>::infinity()) {
+            if (const auto removed = reducedCostFixing(inst, rmpObj, diveUpperBound, pricing); removed > 0 && verbose)
+               cout << "\tReduced-cost fixing removed " << removed << " arcs." << endl;
+         }
+
+         // Lagrangian bound of the RMP with the current fixings.
+         double bound = rmpObj;
          for (size_t i = 0; i < pricing.size(); ++i) {
             auto &sp = pricing[i];
             const auto pobj = sp->getObjValue();
+            bound += inst.depotCapacity(sp->depotId()) * min(0.0, pobj);
             if (pobj <= -0.0001) {
                newCols += sp->generateColumns();
-               continueCg = true;
             }
          }
-         cout << "\tIter: " << iter << "\tcgIter: " << cgIter << "\tRMP: " << rmpObj << "\tcols: " << rmp.numColumns() << "+" << newCols << "\tseconds: " << timer.elapsed() << endl;
+         lbObj = max(lbObj, bound);
+         if (verbose)
+            cout << "\tIter: " << iter << "\tcgIter: " << cgIter << "\tRMP: " << rmpObj << "\tcols: " << rmp.numColumns() << "+" << newCols << "\tseconds: " << timer.elapsed() << endl;
          if (!newCols) {
             optimizeRmp = true; // CG stopped due to max number of iters
             break;
@@ -677,8 +1482,62 @@ auto solveTruncatedColumnGeneration(const Instance &inst, CgMasterBase &rmp, vec
          maxThreads = inst.numDepots();
       }
 
-      if (optimizeRmp)
+      if (!lastBatch.empty() && rmpObj >= 1e7) {
+         for (int col: lastBatch)
+            unfixColumn(col);
+         lastBatch.clear();
+         if (!decisions.empty())
+            decisions.back().fixed.resize(1);
+         batchFixing = false;
+         if (verbose)
+            cout << "Batch fixing made the RMP infeasible. Falling back to single column fixing." << endl;
+         continue;
+      }
+      lastBatch.clear();
+
+      // Reverts the recent rounds when the last one degraded the RMP past the threshold,
+      // or left it relying on dummy columns. The deepest round with alternatives left
+      // takes its next candidate instead.
+      if (backtracksLeft > 0 && !decisions.empty() && 
+         (rmpObj >= 1e7 || rmpObj > decisions.back().rmpObj * (1.0 + settings.backtrackThreshold))) {
+         int target = decisions.size() - 1;
+         while (target >= 0 && decisions[target].alternatives.empty())
+            --target;
+         if (target >= 0) {
+            while ((int) decisions.size() > target + 1) {
+               for (int col: decisions.back().fixed)
+                  unfixColumn(col);
+               decisions.pop_back();
+            }
+            auto &decision = decisions.back();
+            for (int col: decision.fixed)
+               unfixColumn(col);
+            rmp.setBasis(decision.basis);
+
+            const int col = decision.alternatives.front();
+            decision.alternatives.erase(decision.alternatives.begin());
+            decision.fixed.assign(1, col);
+            fixColumn(col);
+            --backtracksLeft;
+            if (verbose)
+               cout << "Backtracking: RMP " << rmpObj << " after " << decisions.size() << " rounds in the window, fixing col#" << col << " instead" << endl;
+            continue;
+         }
+      }
+
+      // Costs are integer, so the dive can only improve the incumbent if the
+      // rounded up bound is smaller than it. The bound is heuristic when the 
+      // number of label expansions is limited.
+      if (ceil(lbObj - 1e-6) >= incumbent) {
+         if (verbose)
+            cout << "Dive abandoned: bound " << lbObj << " can not improve " << incumbent << endl;
+         return numeric_limits<double>::infinity();
+      }
+
+      if (optimizeRmp) {
          rmp.solve();
+         ++rmpSolves;
+      }
 
       graspCandidates.clear();
       for (int col = 0; col < rmp.numColumns(); ++col) {
@@ -690,26 +1549,23 @@ auto solveTruncatedColumnGeneration(const Instance &inst, CgMasterBase &rmp, vec
          if (value <= 1e-6)
             continue;
 
-         if (!isFixFeasible(col))
+         if (!isFixFeasible(col) || depotFixed[rmp.columnDepot(col)] >= inst.depotCapacity(rmp.columnDepot(col)))
             continue;
 
          Candidate candidate;
          candidate.column = col;
          candidate.value = value;
 
-         if (varSelection == TCG_VAR_SEL_SIMPLE) {
+         if (settings.varSelection == TCG_VAR_SEL_SIMPLE) {
             graspCandidates.push_back(candidate);
          } else {
-            if (graspStrategy == TCG_GRASP_STRATEGY_DIRECT) {
+            if (settings.graspStrategy == TCG_GRASP_STRATEGY_DIRECT) {
                candidate.cost = rmp.getCost(col);
                graspCandidates.push_back(candidate);
             } else {
-               if (graspCandidates.empty() || value > 0.2) {
-                  rmp.setLb(col, 1.0);
-                  candidate.cost = rmp.solve();
+               // Evaluated below.
+               if (graspCandidates.empty() || value > 0.2)
                   graspCandidates.push_back(candidate);
-                  rmp.setLb(col, 0.0);
-               }
             }
          }
       }
@@ -717,35 +1573,181 @@ auto solveTruncatedColumnGeneration(const Instance &inst, CgMasterBase &rmp, vec
       if (graspCandidates.empty()) 
          break;
 
+      // Evaluates the bound of the RMP after fixing each candidate. Evaluations are 
+      // spread over workers holding copies of the RMP, which are kept in sync with it 
+      // incrementally, so their bases stay warm. Fixing a column keeps the basis dual
+      // feasible, and the dual simplex stops once the bound exceeds the incumbent.
+      if (settings.varSelection != TCG_VAR_SEL_SIMPLE && settings.graspStrategy == TCG_GRASP_STRATEGY_EVAL) {
+         const double objLimit = min<double>(upperBound, incumbent);
+         // GLPK problems must stay in the thread that created them, so the GLPK master
+         // evaluates the candidates itself.
+         const bool serial = omp_in_parallel() || dynamic_cast<CgMasterGlpk *>(&rmp) != nullptr;
+         const int numWorkers = serial ? 1 : min<int>(omp_get_max_threads(), graspCandidates.size());
+         if (numWorkers <= 1) {
+            rmp.setObjLimit(objLimit);
+            for (auto &candidate: graspCandidates) {
+               rmp.setLb(candidate.column, 1.0);
+               candidate.cost = rmp.solve('d');
+               rmp.setLb(candidate.column, 0.0);
+            }
+            rmp.setObjLimit(numeric_limits<double>::infinity());
+            rmpSolves += graspCandidates.size();
+         } else {
+            while ((int) evalWorkers.size() < numWorkers)
+               evalWorkers.push_back(rmp.clone());
+            for (int w = 0; w < numWorkers; ++w) {
+               evalWorkers[w]->syncWith(rmp);
+               evalWorkers[w]->setObjLimit(objLimit);
+            }
+
+            #pragma omp parallel for default(shared) schedule(dynamic, 1) num_threads(numWorkers)
+            for (size_t c = 0; c < graspCandidates.size(); ++c) {
+               auto &worker = *evalWorkers[omp_get_thread_num()];
+               auto &candidate = graspCandidates[c];
+               worker.setLb(candidate.column, 1.0);
+               candidate.cost = worker.solve('d');
+               worker.setLb(candidate.column, 0.0);
+            }
+            rmpSolves += graspCandidates.size();
+         }
+      }
+
       int bestCol = -1;
       double bestBnd = 0.0;
-      if (varSelection == TCG_VAR_SEL_SIMPLE) {
+      if (settings.varSelection == TCG_VAR_SEL_SIMPLE) {
          sort(graspCandidates.rbegin(), graspCandidates.rend(), candValueComp);
          bestCol = graspCandidates.front().column;
          bestBnd = graspCandidates.front().value;
       } else {
          sort(graspCandidates.begin(), graspCandidates.end(), candCostComp);
-         auto maxPos = max(1, (int) trunc(graspCandidates.size() * graspAlpha));
+         auto maxPos = max(1, (int) trunc(graspCandidates.size() * settings.graspAlpha));
          dist = uniform_int_distribution<size_t>(0, maxPos-1);
          const auto selection = dist(rng);
          bestCol = graspCandidates[selection].column;
          bestBnd = graspCandidates[selection].value;
       }
 
-      cout << "Fixing col#" << bestCol << " with bound=" << bestBnd << endl;
-      rmp.setLb(bestCol, 1.0);
-      updateCoverCount(bestCol);
-      cout << "Trips covered so far: " << coverCount << " out of " << inst.numTrips() << endl;
+      // Records the round before fixing, so it can be reverted later.
+      if (settings.maxBacktracks > 0) {
+         Decision decision;
+         decision.basis = rmp.getBasis();
+         decision.rmpObj = rmpObj;
+         for (const auto &candidate: graspCandidates) {
+            if (candidate.column != bestCol && (int) decision.alternatives.size() < settings.backtrackDepth)
+               decision.alternatives.push_back(candidate.column);
+         }
+         decisions.push_back(move(decision));
+         if ((int) decisions.size() > settings.backtrackDepth)
+            decisions.pop_front();
+      }
+
+      fixColumn(bestCol);
+      if (verbose)
+         cout << "Fixing col#" << bestCol << " with bound=" << bestBnd << endl;
+
+      // Batch fixing: also fixes the compatible candidates with the largest values,
+      // up to `fixTopK` columns per round, and every one above `fixThreshold`.
+      if (batchFixing) {
+         sort(graspCandidates.rbegin(), graspCandidates.rend(), candValueComp);
+         int fixedInRound = 1;
+         for (const auto &candidate: graspCandidates) {
+            const int col = candidate.column;
+            const int depot = rmp.columnDepot(col);
+            const bool aboveThreshold = settings.fixThreshold > 0.0 && candidate.value >= settings.fixThreshold;
+            if (fixedInRound >= settings.fixTopK && !aboveThreshold)
+               break;
+            if (col == bestCol || !isFixFeasible(col) || depotFixed[depot] >= inst.depotCapacity(depot))
+               continue;
+            fixColumn(col);
+            lastBatch.push_back(col);
+            if (!decisions.empty())
+               decisions.back().fixed.push_back(col);
+            ++fixedInRound;
+         }
+         if (verbose && !lastBatch.empty())
+            cout << "Fixing " << lastBatch.size() << " more columns in the batch" << endl;
+      }
+      if (verbose)
+         cout << "Trips covered so far: " << coverCount << " out of " << inst.numTrips() << endl;
    }   
 
-   cout << "Truncated column generation finished after " << timer.elapsed() << " seconds" << endl;
+   if (verbose)
+      cout << "Dive finished after " << iter << " rounds, " << rmpSolves << " RMP solves, and " << 
+         settings.maxBacktracks - backtracksLeft << " backtracks" << endl;
 
-   rmp.writeLp("masterTcgFix.lp");
-   rmp.convertToBinary();
-   rmp.writeLp("masterTcgFixInt.lp");
-   for (int col = 0; col < rmp.numColumns(); ++col)
-      rmp.setLb(col, 0.0);
-   rmp.writeLp("masterTcgInt.lp");
-   rmp.convertToRelaxed();
-   rmp.writeLp("masterTcg.lp");
-}
\ No newline at end of file
+   if (coverCount < inst.numTrips())
+      return numeric_limits<double>::infinity();
+
+   double value = 0.0;
+   for (int col = 0; col < rmp.numColumns(); ++col) {
+      if (rmp.getLb(col) >= 0.5)
+         value += rmp.getCost(col);
+   }
+   return value;
+}
+
+auto reducedCostFixing(const Instance &inst, double rmpObj, double upperBound, vector<unique_ptr<CgPricingBase>> &pricing) noexcept -> int {
+   // Computes the labels over the current duals, and the Lagrangian bound given by them.
+   // Each depot can use up to its capacity in copies of its best path.
+   vector<double> bestReducedCost(pricing.size());
+   #pragma omp parallel for default(shared) schedule(static, 1)
+   for (size_t i = 0; i < pricing.size(); ++i) {
+      bestReducedCost[i] = pricing[i]->computeReducedCostLabels();
+   }
+
+   double lagrangianBound = rmpObj;
+   for (size_t i = 0; i < pricing.size(); ++i) {
+      lagrangianBound += inst.depotCapacity(pricing[i]->depotId()) * min(0.0, bestReducedCost[i]);
+   }
+
+   // Nothing to do if the bound already proves the upper bound is optimal.
+   const auto gap = upperBound - lagrangianBound;
+   if (gap < 1.0)
+      return 0;
+
+   int removed = 0;
+   #pragma omp parallel for default(shared) schedule(static, 1) reduction(+:removed)
+   for (size_t i = 0; i < pricing.size(); ++i) {
+      removed += pricing[i]->fixArcsByReducedCost(gap);
+   }
+
+   return removed;
+}
+
+// GLPK keeps its memory in an environment per thread, so its problems can not be written by the
+// export thread. The snapshot is then a native master with the same rows, columns, costs, names
+// and bounds, which needs no solver and is filled from the cached columns without a GLPK copy.
+auto snapshotMaster(const Instance &inst, const CgMasterBase &master) noexcept -> shared_ptr<CgMasterBase> {
+   if (dynamic_cast<const CgMasterGlpk *>(&master) == nullptr)
+      return master.clone();
+
+   auto snapshot = make_shared<CgMasterNative>(inst);
+   snapshot->setAssignmentType('E');
+   snapshot->syncWith(master);
+   return snapshot;
+}
+
+auto pushSnapshot(ExportQueue &exports, const string &fname, const shared_ptr<CgMasterBase> &snapshot, function<void(CgMasterBase &, const char *)> write, bool compressible) noexcept -> string {
+   return exports.push(fname, [snapshot, write = move(write)](const char *f) { write(*snapshot, f); }, compressible);
+}
+
+auto readTripMap(const char *fname) noexcept -> vector<int> {
+   ifstream fid(fname);
+   if (!fid) {
+      cout << "Could not open trip map file: " << fname << "\n";
+      exit(EXIT_FAILURE);
+   }
+
+   vector<int> tripMap;
+   int oldId, newId;
+   while (fid >> oldId >> newId) {
+      if (oldId < 0 || newId < -1) {
+         cout << "Bad trip ids in map file: " << oldId << " " << newId << "\n";
+         exit(EXIT_FAILURE);
+      }
+      if (oldId >= int(tripMap.size()))
+         tripMap.resize(oldId + 1, -1);
+      tripMap[oldId] = newId;
+   }
+   return tripMap;
+}